@@ -2,10 +2,17 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
 #include <vector>
 #include <functional>
 #include <cassert>
 #include <unordered_map>
+#include <cstdint>
+#include <type_traits>
+#include <chrono>
+#include <future>
+#include <tuple>
+#include <limits>
 
 #ifdef EMBCONSOLE_STATIC
 #define EmbConsole_EXPORT
@@ -54,6 +61,7 @@ namespace emb {
         class PrintCommand;
         class PromptCommand;
         class Terminal;
+        class PrintBatch;
         using TerminalPtr = std::shared_ptr<Terminal>;
         namespace table { struct Table; }
 
@@ -61,6 +69,41 @@ namespace emb {
         ///// User Console Commands
         //////////////////////////////////////////////////
 
+        /**
+         * @brief Tells a running command that it must stop. Copies share the same state.
+         *        The console cancels a command when Ctrl-C is pressed while it is the foreground command (the last one started
+         *        from the prompt), and when the timeout of the command expires.
+         */
+        class EmbConsole_EXPORT CancellationToken {
+        public:
+            CancellationToken() noexcept;
+            /**
+             * @brief Creates a token
+             * @param a_Timeout     Duration after which the token is cancelled by itself, 0 for none
+             */
+            explicit CancellationToken(std::chrono::milliseconds const a_Timeout) noexcept;
+
+            /**
+             * @brief Tells if the command must stop
+             */
+            bool isCancelled() const noexcept;
+            /**
+             * @brief Sleeps until the token is cancelled, to be used by commands instead of sleeping
+             * @param a_Duration    Maximum duration to wait
+             * @return bool         True if the token is cancelled
+             */
+            bool waitFor(std::chrono::milliseconds const a_Duration) const noexcept;
+            /**
+             * @brief Cancels the token, and wakes up the threads waiting for it
+             * @return bool         False if the token was already cancelled
+             */
+            bool cancel() const noexcept;
+
+        private:
+            struct State;
+            std::shared_ptr<State> m_pState;
+        };
+
         struct UserCommandData {
             using Arg = std::string;
             using Args = std::vector<Arg>;
@@ -68,6 +111,19 @@ namespace emb {
             UserCommandInfo const& info;
             ConsoleSession& console;
             Args args;
+            CancellationToken cancellation{};   ///< Cancelled by Ctrl-C or by the timeout of the command, must be checked by long commands
+
+            /**
+             * @brief Reports that the command failed (e.g. invalid arguments): it is counted as a failure, and its result
+             *        given by execCommand is Failed. A command throwing an exception fails the same way.
+             */
+            void fail() const noexcept { *failure = true; }
+            /**
+             * @brief Tells if the command reported a failure
+             */
+            bool hasFailed() const noexcept { return *failure; }
+
+            std::shared_ptr<std::atomic<bool>> failure{ std::make_shared<std::atomic<bool>>(false) };   ///< Set by fail()
         };
 
         struct UserCommandAutoCompleteData {
@@ -76,6 +132,7 @@ namespace emb {
 
             Args args;
             Arg partialArg;
+            CancellationToken cancellation{};   ///< Cancelled when the entry changes or when the completion takes too long
         };
 
         using UserCommandFunctor0 = std::function<void(void)>;
@@ -88,13 +145,16 @@ namespace emb {
             std::string description;            ///< Description of the command
             std::string help;                   ///< Text of the help. displayed with command "help <cmd>"
             std::vector<std::string> users;     ///< Users that can see the command. empty = all users
-            UserCommandInfo(char const* a_szPath) : path(a_szPath) {}
+            std::chrono::milliseconds timeout;  ///< Duration after which the command is cancelled. 0 = no timeout
+            UserCommandInfo(char const* a_szPath) : path(a_szPath), timeout(0) {}
             UserCommandInfo(std::string const& a_strPath = "", std::string const& a_strDescription = "",
-                std::string const& a_strHelp = "", std::vector<std::string> const& a_vstrUsers = {})
+                std::string const& a_strHelp = "", std::vector<std::string> const& a_vstrUsers = {},
+                std::chrono::milliseconds const a_Timeout = std::chrono::milliseconds{ 0 })
                 : path(a_strPath)
                 , description(a_strDescription)
                 , help(a_strHelp)
                 , users(a_vstrUsers)
+                , timeout(a_Timeout)
             {}
             void validate() const noexcept {
                 assert(path.size() > 1);
@@ -103,6 +163,43 @@ namespace emb {
             }
         };
 
+        /**
+         * @brief Command and its functions, as given to Console::addCommands()
+         */
+        struct UserCommand {
+            UserCommandInfo info;                   ///< Information about the command
+            UserCommandFunctor0 function0;          ///< Function of the command if it takes no data
+            UserCommandFunctor1 function1;          ///< Function of the command if it takes the data
+            UserCommandAutoCompleteFunctor autoComplete;    ///< Completes the arguments, may be empty
+            UserCommand(UserCommandInfo const& a_Info, UserCommandFunctor0 const& a_funcCommand,
+                UserCommandAutoCompleteFunctor const& a_funcAutoComplete = nullptr)
+                : info(a_Info)
+                , function0(a_funcCommand)
+                , autoComplete(a_funcAutoComplete)
+            {}
+            UserCommand(UserCommandInfo const& a_Info, UserCommandFunctor1 const& a_funcCommand,
+                UserCommandAutoCompleteFunctor const& a_funcAutoComplete = nullptr)
+                : info(a_Info)
+                , function1(a_funcCommand)
+                , autoComplete(a_funcAutoComplete)
+            {}
+        };
+
+        /**
+         * @brief Result of a command executed by Console::execCommand()
+         */
+        struct UserCommandResult {
+            enum class Status {
+                Success,            ///< The command ran until its end
+                NotFound,           ///< No command of the application has this path
+                TooManyCommands,    ///< Too many commands were already running or waiting, the command was not started
+                Cancelled,          ///< The command was cancelled by its timeout, or because the console was destroyed
+                Failed              ///< The command called UserCommandData::fail() or threw an exception
+            };
+            Status status{ Status::Success };
+            std::string output{};   ///< Text printed by the command, without colors nor cursor moves
+        };
+
         //////////////////////////////////////////////////
         ///// Autocompletion tools
         //////////////////////////////////////////////////
@@ -146,6 +243,48 @@ namespace emb {
                 std::string const& a_strPartialArg, std::vector<std::string> const& a_vecChoices) noexcept;
         }
 
+        //////////////////////////////////////////////////
+        ///// Deferred formatting
+        //////////////////////////////////////////////////
+
+        /**
+         * @brief Raw argument of a deferred format: the producer only copies its value, the text is built by the console thread
+         */
+        struct EmbConsole_EXPORT FormatArg {
+            enum class Type : unsigned char {
+                Int,
+                UInt,
+                Double,
+                Bool,
+                Char,
+                Text,
+                Pointer
+            };
+            union Value {
+                long long llInt;
+                unsigned long long ullUInt;
+                double dDouble;
+                char const* szText;
+                void const* pPointer;
+            };
+
+            FormatArg(bool a_bValue) noexcept : eType{ Type::Bool } { value.ullUInt = a_bValue ? 1 : 0; }
+            FormatArg(char a_cValue) noexcept : eType{ Type::Char } { value.ullUInt = static_cast<unsigned char>(a_cValue); }
+            template<typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+            FormatArg(T a_Value) noexcept : eType{ Type::Int } { value.llInt = a_Value; }
+            template<typename T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, int>::type = 0>
+            FormatArg(T a_Value) noexcept : eType{ Type::UInt } { value.ullUInt = a_Value; }
+            template<typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+            FormatArg(T a_Value) noexcept : eType{ Type::Double } { value.dDouble = static_cast<double>(a_Value); }
+            FormatArg(char const* a_szText) noexcept : eType{ Type::Text }, ulSize{ a_szText ? std::char_traits<char>::length(a_szText) : 0 } { value.szText = a_szText ? a_szText : ""; }
+            FormatArg(std::string const& a_strText) noexcept : eType{ Type::Text }, ulSize{ a_strText.size() } { value.szText = a_strText.data(); }
+            FormatArg(void const* a_pPointer) noexcept : eType{ Type::Pointer } { value.pPointer = a_pPointer; }
+
+            Type eType;
+            Value value;
+            size_t ulSize{ 0 };     ///< Size of the text, only used by Type::Text
+        };
+
         //////////////////////////////////////////////////
         ///// Console stream object
         //////////////////////////////////////////////////
@@ -165,6 +304,20 @@ namespace emb {
             void print(std::string const& a_Data) noexcept;
             void printError(std::string const& a_Data) noexcept;
             void printTable(table::Table const& a_stTable) noexcept;
+
+            /**
+             * @brief Prints text built from a format and arguments, like print(std::string const&).
+             *        The calling thread only copies the raw arguments, the text is formatted later by the console thread, and not
+             *        at all if no terminal prints it (e.g. dropped by a full output queue).
+             * @param a_szFormat    Format, each "{}" is replaced by the next argument, "{{" and "}}" print braces
+             * @param a_Arg         Arguments: integers, floating point numbers, booleans, characters, strings and pointers
+             */
+            template<typename Arg, typename... Args>
+            void print(char const* a_szFormat, Arg const& a_Arg, Args const&... a_Args) noexcept {
+                FormatArg const aArgs[]{ FormatArg(a_Arg), FormatArg(a_Args)... };
+                printFormat(a_szFormat, aArgs, 1 + sizeof...(Args));
+            }
+            void printFormat(char const* a_szFormat, FormatArg const* a_pArgs, size_t a_ulNbArgs) noexcept;
         };
 
         /**
@@ -218,6 +371,48 @@ namespace emb {
             std::unique_ptr<Private> m_pPrivateImpl;
         };
 
+        //////////////////////////////////////////////////
+        ///// Output queues
+        //////////////////////////////////////////////////
+
+        /**
+         * @brief Limits the prints waiting to be output by a sink, and tells what happens to a committed print when they are reached
+         */
+        struct EmbConsole_EXPORT OutputQueuePolicy {
+            enum class Overflow {
+                Block,          ///< The producer waits until the sink has room (prints committed by the console thread itself are dropped)
+                DropNewest,     ///< The print being committed is dropped
+                DropOldest,     ///< The oldest queued prints are dropped to make room
+                Sample          ///< One print out of uiSampleRate is kept, by dropping the oldest queued ones, the others are dropped
+            };
+            Overflow eOverflow{ Overflow::DropOldest };
+            size_t ulMaxRecords{ 4096 };            ///< Maximum number of queued prints (committed transactions)
+            size_t ulMaxBytes{ 4 * 1024 * 1024 };   ///< Maximum size of the queued prints, a single bigger print is still accepted by an empty queue
+            unsigned int uiSampleRate{ 10 };        ///< Only used by the Sample policy
+        };
+
+        /**
+         * @brief State and counters of the output queue of a sink
+         */
+        struct EmbConsole_EXPORT OutputQueueStats {
+            std::string strSink{};
+            size_t ulQueuedRecords{ 0 };
+            size_t ulQueuedBytes{ 0 };
+            uint64_t ulDropped{ 0 };    ///< Prints dropped because the queue was full
+            uint64_t ulSampled{ 0 };    ///< Prints skipped by the sampling
+            uint64_t ulBlocked{ 0 };    ///< Times a producer had to wait for room
+        };
+
+        /**
+         * @brief Counters of the standard output capture. A reader thread keeps the capture pipe empty, so the application only
+         *        waits on a write if this thread is starved. What cannot be delivered is dropped and counted.
+         */
+        struct EmbConsole_EXPORT StandardOutputCaptureStats {
+            uint64_t ulCapturedBytes{ 0 };  ///< Bytes read from the capture pipe
+            uint64_t ulDroppedBytes{ 0 };   ///< Bytes read but dropped because the captured text was not delivered fast enough
+            uint64_t ulPipeFull{ 0 };       ///< Times the capture pipe was found full: the application may have waited for the reader
+        };
+
         //////////////////////////////////////////////////
         ///// Console object
         //////////////////////////////////////////////////
@@ -263,15 +458,60 @@ namespace emb {
 
             void addCommand(UserCommandInfo const&, UserCommandFunctor0 const&, UserCommandAutoCompleteFunctor const& = nullptr) noexcept;
             void addCommand(UserCommandInfo const&, UserCommandFunctor1 const&, UserCommandAutoCompleteFunctor const& = nullptr) noexcept;
+            /**
+             * @brief Adds a command with typed arguments, e.g. addCommand<int, std::string, double>(info, [](int, std::string const&, double) {})
+             *        The arguments are parsed and validated before the function is called, without exceptions. The usage
+             *        string (used as help if the info has none) and the autocompletion of each argument are generated from
+             *        the types, see arguments::Parser to support other types.
+             * @tparam Arg0, Args   Types of the arguments, in order
+             * @param a_CommandInfo Information about the command
+             * @param a_Function    Called with the parsed arguments, optionally preceded by the UserCommandData
+             */
+            template<typename Arg0, typename... Args, typename F>
+            void addCommand(UserCommandInfo const& a_CommandInfo, F a_Function) noexcept;
+            /**
+             * @brief Adds several commands at once. The commands are shared by all the sinks and each change to them is
+             *        published to the sinks as a whole: adding many commands is much faster this way than one by one.
+             * @param a_vCommands   Commands to add, replacing the commands with the same paths
+             */
+            void addCommands(std::vector<UserCommand> const& a_vCommands) noexcept;
             void delCommand(UserCommandInfo const&) noexcept;
             void delAllCommands() noexcept;
 
-            void execCommand(UserCommandInfo const&, UserCommandData::Args const& = {}) noexcept;
+            /**
+             * @brief Executes a command of the application in the background, as if it was typed, without any terminal: its
+             *        output is captured in memory instead of being printed, and its prompts are cancelled.
+             * @param a_CommandInfo Information about the command, only its path is used
+             * @param a_CommandArgs Arguments given as they are to the command, neither joined nor parsed again
+             * @return std::future<UserCommandResult>   Ready when the command ends, or right away if it cannot be started
+             */
+            std::future<UserCommandResult> execCommand(UserCommandInfo const&, UserCommandData::Args const& = {}) noexcept;
 
             void setStandardOutputCapture(StandardOutputFunctor const&) noexcept;
+            /**
+             * @brief Gives the counters of the standard output capture
+             */
+            StandardOutputCaptureStats getStandardOutputCaptureStats() const noexcept;
+
+            /**
+             * @brief Prints the output of a file descriptor (pipe, pty master, socket...) as a named stream: each line is
+             *        printed on every sink, prefixed by "[name] ". The descriptor is read by the console thread when it is
+             *        readable. The stream is removed at the end of the file, the descriptor is never closed by the console.
+             * @param a_strName     Name of the stream
+             * @param a_iFd         Descriptor, switched to non-blocking mode
+             * @return bool         False if the name is already used, or if streams are not supported on the platform
+             */
+            bool addInputStream(std::string const& a_strName, int a_iFd) noexcept;
+            void delInputStream(std::string const& a_strName) noexcept;
 
             void setPromptEnabled(bool) noexcept;
 
+            /**
+             * @brief Gives the state and the counters of the output queue of every sink
+             * @return std::vector<OutputQueueStats> One entry per sink
+             */
+            std::vector<OutputQueueStats> getOutputQueueStats() const noexcept;
+
         private:
             class Private;
             std::unique_ptr<Private> m_pPrivateImpl;
@@ -289,6 +529,28 @@ namespace emb {
             std::string strDesc{};
         };
 
+        /**
+         * @brief Option of a sink, i.e. a terminal the prints are output on
+         */
+        class EmbConsole_EXPORT OptionSink : public Option {
+        public:
+            explicit OptionSink(OutputQueuePolicy::Overflow a_eDefaultOverflow = OutputQueuePolicy::Overflow::DropOldest) noexcept { outputQueue.eOverflow = a_eDefaultOverflow; }
+            /**
+             * @brief Sets the limits of the prints waiting to be output by the sink
+             * @param a_OutputQueue Limits and overflow policy
+             * @return OptionSink&  This option, so that it can be added to Options directly
+             */
+            OptionSink& setOutputQueue(OutputQueuePolicy const& a_OutputQueue) noexcept { outputQueue = a_OutputQueue; return *this; }
+            /**
+             * @brief Limits how often the prompt is redrawn, e.g. during a burst of prints
+             * @param a_uiMaxPromptRedrawRate   Maximum number of redraws per second, 0 for no limit
+             * @return OptionSink&  This option, so that it can be added to Options directly
+             */
+            OptionSink& setMaxPromptRedrawRate(unsigned int a_uiMaxPromptRedrawRate) noexcept { uiMaxPromptRedrawRate = a_uiMaxPromptRedrawRate; return *this; }
+            OutputQueuePolicy outputQueue{};
+            unsigned int uiMaxPromptRedrawRate{ 30 };
+        };
+
         /**
          * @brief Represents Options that can be passed to the library
          *
@@ -326,49 +588,51 @@ namespace emb {
             std::vector<std::shared_ptr<Option>> m_vpOptions{};
         };
 
-        class EmbConsole_EXPORT OptionStd : public Option {
+        class EmbConsole_EXPORT OptionStd : public OptionSink {
         public:
             OptionStd() noexcept { strDesc = "OptionStd()"; };
             OptionStd(bool a_bEnabled) noexcept : bEnabled{ a_bEnabled } { strDesc = "OptionStd(" + std::to_string(a_bEnabled) + ")"; }
-            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionStd>(bEnabled); }
+            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionStd>(*this); }
             bool bEnabled{ true };
         };
 
-        class EmbConsole_EXPORT OptionFile : public Option {
+        class EmbConsole_EXPORT OptionFile : public OptionSink {
         public:
-            OptionFile() noexcept { strDesc = "OptionFile()"; };
-            OptionFile(bool a_bEnabled, std::string const& a_strFilePath) noexcept : bEnabled{ a_bEnabled }, strFilePath{ a_strFilePath }
+            // A file keeps all the prints by default
+            OptionFile() noexcept : OptionSink{ OutputQueuePolicy::Overflow::Block } { strDesc = "OptionFile()"; };
+            OptionFile(bool a_bEnabled, std::string const& a_strFilePath) noexcept
+                : OptionSink{ OutputQueuePolicy::Overflow::Block }, bEnabled{ a_bEnabled }, strFilePath{ a_strFilePath }
             { strDesc = "OptionFile(" + std::to_string(a_bEnabled) + "," + a_strFilePath + ")"; }
-            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionFile>(bEnabled, strFilePath); }
+            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionFile>(*this); }
             bool bEnabled{ false };
             std::string strFilePath{};
         };
 
-        class EmbConsole_EXPORT OptionUnixSocket : public Option {
+        class EmbConsole_EXPORT OptionUnixSocket : public OptionSink {
         public:
             OptionUnixSocket() noexcept { strDesc = "OptionUnixSocket()"; };
             OptionUnixSocket(bool a_bEnabled, std::string const& a_strSocketFilePath, std::string const& a_strShellFilePath) noexcept
                 : bEnabled{ a_bEnabled }, strSocketFilePath{ a_strSocketFilePath }, strShellFilePath{ a_strShellFilePath }
             { strDesc = "OptionUnixSocket(" + std::to_string(a_bEnabled) + "," + strSocketFilePath + "," + a_strShellFilePath + ")"; }
-            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionUnixSocket>(bEnabled, strSocketFilePath, strShellFilePath); }
+            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionUnixSocket>(*this); }
             bool bEnabled{ false };
             std::string strSocketFilePath{};
             std::string strShellFilePath{};
         };
 
-        class EmbConsole_EXPORT OptionLocalTcpServer : public Option {
+        class EmbConsole_EXPORT OptionLocalTcpServer : public OptionSink {
         public:
             OptionLocalTcpServer() noexcept { strDesc = "OptionLocalTcpServer()"; };
             OptionLocalTcpServer(bool a_bEnabled, int a_iPort, std::string const& a_strShellFilePath) noexcept
                 : bEnabled{ a_bEnabled }, iPort{ a_iPort }, strShellFilePath{ a_strShellFilePath }
             { strDesc = "OptionLocalTcpServer(" + std::to_string(a_bEnabled) + ",127.0.0.1:" + std::to_string(iPort) + "," + strShellFilePath + ")"; }
-            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionLocalTcpServer>(bEnabled, iPort, strShellFilePath); }
+            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionLocalTcpServer>(*this); }
             bool bEnabled{ false };
             int iPort{};
             std::string strShellFilePath{};
         };
 
-        class EmbConsole_EXPORT OptionSyslog : public Option {
+        class EmbConsole_EXPORT OptionSyslog : public OptionSink {
         public:
             enum class Criticity {
                 Emergency,
@@ -390,11 +654,12 @@ namespace emb {
                 Info(std::string const& a_strRawMessage) : strMessage{ a_strRawMessage } {}
             };
         public:
-            OptionSyslog() noexcept { strDesc = "OptionSyslog()"; };
+            // The syslog keeps all the prints by default
+            OptionSyslog() noexcept : OptionSink{ OutputQueuePolicy::Overflow::Block } { strDesc = "OptionSyslog()"; };
             OptionSyslog(bool a_bEnabled, std::string const& a_strDestination, std::function<Info(std::string const&)> const& a_fctGetInfo = nullptr) noexcept
-                : bEnabled{ a_bEnabled }, strDestination{ a_strDestination }, m_fctGetInfo{ a_fctGetInfo }
+                : OptionSink{ OutputQueuePolicy::Overflow::Block }, bEnabled{ a_bEnabled }, strDestination{ a_strDestination }, m_fctGetInfo{ a_fctGetInfo }
             { strDesc = "OptionSyslog(" + std::to_string(a_bEnabled) + "," + strDestination + ")"; }
-            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionSyslog>(bEnabled, strDestination, m_fctGetInfo); }
+            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionSyslog>(*this); }
             Info getInfo(std::string const& a_strRawMessage) const noexcept { if (m_fctGetInfo) { return m_fctGetInfo(a_strRawMessage); } return Info{ a_strRawMessage }; }
             bool bEnabled{ false };
             std::string strDestination{};
@@ -402,6 +667,32 @@ namespace emb {
             std::function<Info(std::string const&)> m_fctGetInfo{};
         };
 
+        class EmbConsole_EXPORT OptionEventLoop : public Option {
+        public:
+            enum class Strategy {
+                Block,          ///< Sleeps until an event occurs, no wake up at all when idle
+                AdaptiveSpin,   ///< Spins for a while before sleeping, to react faster to bursts of events
+                BusyPoll        ///< Never sleeps: lowest latency, but keeps a CPU core busy
+            };
+        public:
+            OptionEventLoop() noexcept { strDesc = "OptionEventLoop()"; };
+            OptionEventLoop(Strategy a_eStrategy, unsigned int a_uiSpinDurationUs = 50) noexcept : eStrategy{ a_eStrategy }, uiSpinDurationUs{ a_uiSpinDurationUs }
+            { strDesc = "OptionEventLoop(" + std::to_string(static_cast<int>(a_eStrategy)) + "," + std::to_string(a_uiSpinDurationUs) + "us)"; }
+            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionEventLoop>(eStrategy, uiSpinDurationUs); }
+            Strategy eStrategy{ Strategy::Block };
+            unsigned int uiSpinDurationUs{ 50 };    ///< Only used by the AdaptiveSpin strategy
+        };
+
+        class EmbConsole_EXPORT OptionHistory : public Option {
+        public:
+            OptionHistory() noexcept { strDesc = "OptionHistory()"; };
+            OptionHistory(size_t a_ulCapacity, std::string const& a_strFilePath = "") noexcept : ulCapacity{ a_ulCapacity }, strFilePath{ a_strFilePath }
+            { strDesc = "OptionHistory(" + std::to_string(a_ulCapacity) + "," + a_strFilePath + ")"; }
+            std::shared_ptr<Option> copy() const noexcept override { return emb::tools::memory::make_unique<OptionHistory>(*this); }
+            size_t ulCapacity{ 1000 };      ///< Entries kept, the oldest ones being dropped
+            std::string strFilePath{};      ///< File the entries are appended to and read back from at start, none if empty
+        };
+
         //////////////////////////////////////////////////
         ///// PrintCommand Base
         //////////////////////////////////////////////////
@@ -417,7 +708,7 @@ namespace emb {
             virtual ~PrintCommand() noexcept;
             PrintCommand& operator= (PrintCommand const&) noexcept;
             PrintCommand& operator= (PrintCommand&&) noexcept;
-            virtual void process(Terminal&) const noexcept = 0;
+            virtual void encode(PrintBatch&) const noexcept = 0;
             virtual Ptr copy() const noexcept = 0;
         };
 
@@ -430,21 +721,51 @@ namespace emb {
             : public PrintCommand{
         public:
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<Begin>(); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         };
         /// Ends a session of print commands. Commands sent between Begin and Commit are treated at the commit.
         class EmbConsole_EXPORT Commit final
             : public PrintCommand{
         public:
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<Commit>(); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
+        };
+        /// Abandons the session of print commands begun by the calling thread, whatever the number of Begin sent: the commands
+        /// sent since the first Begin are discarded.
+        class EmbConsole_EXPORT Rollback final
+            : public PrintCommand{
+        public:
+            Ptr copy() const noexcept override { return emb::tools::memory::make_unique<Rollback>(); }
+            void encode(PrintBatch&) const noexcept override;
+        };
+        /// Begins a session of print commands when built, ends it with commit(). A transaction destroyed without being committed
+        /// (e.g. by an exception) sends Rollback, so that its commands are not published by a later Commit.
+        class EmbConsole_EXPORT Transaction final {
+        public:
+            explicit Transaction(IPrintableConsole& a_rConsole) noexcept : m_rConsole(a_rConsole) { m_rConsole << Begin(); }
+            Transaction(Transaction const&) = delete;
+            Transaction& operator= (Transaction const&) = delete;
+            ~Transaction() noexcept {
+                if (!m_bEnded) {
+                    m_rConsole << Rollback();
+                }
+            }
+            void commit() noexcept {
+                if (!m_bEnded) {
+                    m_bEnded = true;
+                    m_rConsole << Commit();
+                }
+            }
+        private:
+            IPrintableConsole& m_rConsole;
+            bool m_bEnded{ false };
         };
         /// Requests the console to print the current list of command instantly when receiving the commit command
         class EmbConsole_EXPORT InstantPrint final
             : public PrintCommand{
         public:
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<InstantPrint>(); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         };
 
         //////////////////////////////////////////////////
@@ -457,7 +778,7 @@ namespace emb {
         public:
             MoveCursorUp(unsigned int const a_uiN) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<MoveCursorUp>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -467,7 +788,7 @@ namespace emb {
         public:
             MoveCursorDown(unsigned int const a_uiN) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<MoveCursorDown>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -477,7 +798,7 @@ namespace emb {
         public:
             MoveCursorForward(unsigned int const a_uiN) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<MoveCursorForward>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -487,7 +808,7 @@ namespace emb {
         public:
             MoveCursorBackward(unsigned int const a_uiN) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<MoveCursorBackward>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -497,7 +818,7 @@ namespace emb {
         public:
             MoveCursorToNextLine(unsigned int const a_uiN) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<MoveCursorToNextLine>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -507,7 +828,7 @@ namespace emb {
         public:
             MoveCursorToPreviousLine(unsigned int const a_uiN) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<MoveCursorToPreviousLine>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -517,7 +838,7 @@ namespace emb {
         public:
             MoveCursorToRow(unsigned int const a_uiR) : m_uiR{ a_uiR } { assert(m_uiR > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<MoveCursorToRow>(m_uiR); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiR{};
         };
@@ -527,7 +848,7 @@ namespace emb {
         public:
             MoveCursorToColumn(unsigned int const a_uiC) : m_uiC{ a_uiC } { assert(m_uiC > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<MoveCursorToColumn>(m_uiC); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiC{};
         };
@@ -537,7 +858,7 @@ namespace emb {
         public:
             MoveCursorToPosition(unsigned int const a_uiR, unsigned int const a_uiC) : m_uiR{ a_uiR }, m_uiC{ a_uiC } { assert(m_uiR > 0 && m_uiC > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<MoveCursorToPosition>(m_uiR, m_uiC); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiR{};
             unsigned int const m_uiC{};
@@ -548,7 +869,7 @@ namespace emb {
         public:
             SaveCursor() {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SaveCursor>(); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         };
         /// Restore Cursor Position from Memory
         class EmbConsole_EXPORT RestoreCursor final
@@ -556,7 +877,7 @@ namespace emb {
         public:
             RestoreCursor() {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<RestoreCursor>(); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         };
 
         //////////////////////////////////////////////////
@@ -569,7 +890,7 @@ namespace emb {
         public:
             SetCursorBlinking(bool const a_bBlinking) : m_bBlinking{ a_bBlinking } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetCursorBlinking>(m_bBlinking); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             bool const m_bBlinking{};
         };
@@ -579,7 +900,7 @@ namespace emb {
         public:
             SetCursorVisible(bool const a_bVisible) : m_bVisible{ a_bVisible } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetCursorVisible>(m_bVisible); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             bool const m_bVisible{};
         };
@@ -604,7 +925,7 @@ namespace emb {
         public:
             SetCursorShape(Shape const a_eShape) : m_eShape{ a_eShape } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetCursorShape>(m_eShape); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             Shape const m_eShape{};
         };
@@ -619,7 +940,7 @@ namespace emb {
         public:
             ScrollUp(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<ScrollUp>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -629,7 +950,7 @@ namespace emb {
         public:
             ScrollDown(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<ScrollDown>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -644,7 +965,7 @@ namespace emb {
         public:
             InsertCharacter(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<InsertCharacter>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -654,7 +975,7 @@ namespace emb {
         public:
             DeleteCharacter(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<DeleteCharacter>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -664,7 +985,7 @@ namespace emb {
         public:
             EraseCharacter(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<EraseCharacter>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -674,7 +995,7 @@ namespace emb {
         public:
             InsertLine(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<InsertLine>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -684,7 +1005,7 @@ namespace emb {
         public:
             DeleteLine(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<DeleteLine>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -700,7 +1021,7 @@ namespace emb {
         public:
             ClearDisplay(Type const a_eType = Type::All) : m_eType{ a_eType } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<ClearDisplay>(m_eType); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             Type const m_eType{};
         };
@@ -716,7 +1037,7 @@ namespace emb {
         public:
             ClearLine(Type const a_eType = Type::All) : m_eType{ a_eType } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<ClearLine>(m_eType); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             Type const m_eType{};
         };
@@ -731,7 +1052,7 @@ namespace emb {
         public:
             ResetTextFormat() {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<ResetTextFormat>(); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         };
         /// Applies color to text foregroug and background.
         class EmbConsole_EXPORT SetColor final
@@ -759,7 +1080,7 @@ namespace emb {
         public:
             SetColor(Color const a_eFgColor, Color const a_eBgColor = Color::Default) : m_eFgColor{ a_eFgColor }, m_eBgColor{ a_eBgColor } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetColor>(m_eFgColor, m_eBgColor); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             Color const m_eFgColor{};
             Color const m_eBgColor{};
@@ -770,7 +1091,7 @@ namespace emb {
         public:
             SetNegativeColors(bool const a_bEnabled) : m_bEnabled{ a_bEnabled } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetNegativeColors>(m_bEnabled); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             bool const m_bEnabled{};
         };
@@ -780,7 +1101,7 @@ namespace emb {
         public:
             SetBold(bool const a_bEnabled) : m_bEnabled{ a_bEnabled } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetBold>(m_bEnabled); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             bool const m_bEnabled{};
         };
@@ -790,7 +1111,7 @@ namespace emb {
         public:
             SetItalic(bool const a_bEnabled) : m_bEnabled{ a_bEnabled } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetItalic>(m_bEnabled); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             bool const m_bEnabled{};
         };
@@ -800,7 +1121,7 @@ namespace emb {
         public:
             SetUnderline(bool const a_bEnabled) : m_bEnabled{ a_bEnabled } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetUnderline>(m_bEnabled); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             bool const m_bEnabled{};
         };
@@ -815,7 +1136,7 @@ namespace emb {
         public:
             SetHorizontalTab() {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetHorizontalTab>(); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         };
         /// Advance the cursor to the next column (in the same row) with a tab stop.
         /// If there are no more tab stops, move to the last column in the row.
@@ -825,7 +1146,7 @@ namespace emb {
         public:
             HorizontalTabForward(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<HorizontalTabForward>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -837,7 +1158,7 @@ namespace emb {
         public:
             HorizontalTabBackward(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<HorizontalTabBackward>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -853,7 +1174,7 @@ namespace emb {
         public:
             ClearHorizontalTab(Type const a_eType = Type::AllColumns) : m_eType{ a_eType } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<ClearHorizontalTab>(m_eType); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             Type const m_eType{};
         };
@@ -868,7 +1189,7 @@ namespace emb {
         public:
             SetDecCharacterSet(bool const a_bEnabled) : m_bEnabled{ a_bEnabled } {}
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetDecCharacterSet>(m_bEnabled); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             bool const m_bEnabled{};
         };
@@ -894,7 +1215,7 @@ namespace emb {
         public:
             PrintSymbol(Symbol const a_eSymbol, unsigned int const a_uiN = 1) : m_eSymbol{ a_eSymbol }, m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<PrintSymbol>(m_eSymbol, m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             Symbol const m_eSymbol{};
             unsigned int const m_uiN{};
@@ -910,7 +1231,7 @@ namespace emb {
         public:
             SetScrollingRegion(unsigned int const a_uiT, unsigned int const a_uiB) : m_uiT{ a_uiT }, m_uiB{ a_uiB } { assert(m_uiT > 0 && m_uiB > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetScrollingRegion>(m_uiT, m_uiB); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiT{};
             unsigned int const m_uiB{};
@@ -926,7 +1247,7 @@ namespace emb {
         public:
             SetWindowTitle(std::string const& a_strTitle) : m_strTitle{ a_strTitle } { assert(m_strTitle.size() < 255); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<SetWindowTitle>(m_strTitle); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             std::string const m_strTitle{};
         };
@@ -941,7 +1262,7 @@ namespace emb {
         public:
             UseAlternateScreenBuffer(bool const& a_bEnabled) : m_bEnabled{ a_bEnabled } { }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<UseAlternateScreenBuffer>(m_bEnabled); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             bool const m_bEnabled{};
         };
@@ -956,7 +1277,7 @@ namespace emb {
         public:
             RingBell() { }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<RingBell>(); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         };
         /// Prints <n> new lines.
         class EmbConsole_EXPORT PrintNewLine final
@@ -964,7 +1285,7 @@ namespace emb {
         public:
             PrintNewLine(unsigned int const a_uiN = 1) : m_uiN{ a_uiN } { assert(m_uiN > 0); }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<PrintNewLine>(m_uiN); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             unsigned int const m_uiN{};
         };
@@ -975,7 +1296,7 @@ namespace emb {
             PrintText(std::string const& a_strText, unsigned int const a_uiR, unsigned int const a_uiC) : m_strText{ a_strText }, m_uiR{ a_uiR }, m_uiC{ a_uiC } { assert(a_uiR > 0 && a_uiC > 0); }
             PrintText(std::string const& a_strText) : m_strText{ a_strText } { }
             Ptr copy() const noexcept override { return emb::tools::memory::make_unique<PrintText>(m_strText); }
-            void process(Terminal&) const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
         private:
             std::string const m_strText{};
             unsigned int const m_uiR{ 0 };
@@ -1242,6 +1563,207 @@ namespace emb {
                 a_stData.console.print(a_strWarning);
                 return a_tDefault;
             }
+
+            /**
+             * @brief Strict conversions, without exceptions: the whole argument must be a value in the range of the type
+             * @return bool     False if the argument is not a valid value
+             */
+            EmbConsole_EXPORT bool parseSigned(std::string const& a_strArg, long long& a_rllValue) noexcept;
+            EmbConsole_EXPORT bool parseUnsigned(std::string const& a_strArg, unsigned long long& a_rullValue) noexcept;
+            EmbConsole_EXPORT bool parseFloating(std::string const& a_strArg, long double& a_rldValue) noexcept;
+            EmbConsole_EXPORT bool parseBool(std::string const& a_strArg, bool& a_rbValue) noexcept;
+
+            /**
+             * @brief Parses the arguments of the typed commands. Specialize it to support other types, providing:
+             *        - static char const* name() noexcept: name of the type in the usage string
+             *        - static bool parse(std::string const& a_strArg, T& a_rValue) noexcept: false if the argument is invalid
+             *        - static std::vector<std::string> choices() noexcept: values proposed by the autocompletion
+             * @tparam T    Type of the argument
+             */
+            template<typename T, typename Enable = void>
+            struct Parser;
+
+            template<typename T>
+            struct Parser<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type> {
+                static char const* name() noexcept { return "int"; }
+                static bool parse(std::string const& a_strArg, T& a_rValue) noexcept {
+                    long long llValue{ 0 };
+                    bool const bRes{ parseSigned(a_strArg, llValue) && llValue >= std::numeric_limits<T>::min() && llValue <= std::numeric_limits<T>::max() };
+                    if (bRes) {
+                        a_rValue = static_cast<T>(llValue);
+                    }
+                    return bRes;
+                }
+                static std::vector<std::string> choices() noexcept { return {}; }
+            };
+
+            template<typename T>
+            struct Parser<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value>::type> {
+                static char const* name() noexcept { return "uint"; }
+                static bool parse(std::string const& a_strArg, T& a_rValue) noexcept {
+                    unsigned long long ullValue{ 0 };
+                    bool const bRes{ parseUnsigned(a_strArg, ullValue) && ullValue <= std::numeric_limits<T>::max() };
+                    if (bRes) {
+                        a_rValue = static_cast<T>(ullValue);
+                    }
+                    return bRes;
+                }
+                static std::vector<std::string> choices() noexcept { return {}; }
+            };
+
+            template<typename T>
+            struct Parser<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+                static char const* name() noexcept { return "number"; }
+                static bool parse(std::string const& a_strArg, T& a_rValue) noexcept {
+                    long double ldValue{ 0 };
+                    bool const bRes{ parseFloating(a_strArg, ldValue) && ldValue >= -std::numeric_limits<T>::max() && ldValue <= std::numeric_limits<T>::max() };
+                    if (bRes) {
+                        a_rValue = static_cast<T>(ldValue);
+                    }
+                    return bRes;
+                }
+                static std::vector<std::string> choices() noexcept { return {}; }
+            };
+
+            template<>
+            struct Parser<bool> {
+                static char const* name() noexcept { return "bool"; }
+                static bool parse(std::string const& a_strArg, bool& a_rValue) noexcept { return parseBool(a_strArg, a_rValue); }
+                static std::vector<std::string> choices() noexcept { return { "false", "true" }; }
+            };
+
+            template<>
+            struct Parser<std::string> {
+                static char const* name() noexcept { return "string"; }
+                static bool parse(std::string const& a_strArg, std::string& a_rValue) noexcept { a_rValue = a_strArg; return true; }
+                static std::vector<std::string> choices() noexcept { return {}; }
+            };
+
+            /**
+             * @brief Parser, usage and autocompletion of a typed command, generated from the types of its arguments
+             * @tparam Args     Types of the arguments, in order
+             */
+            template<typename... Args>
+            class TypedCommand {
+            public:
+                using Values = std::tuple<typename std::decay<Args>::type...>;
+
+                /**
+                 * @brief Gives the usage string of the command, e.g. "Usage: /cmd <int> <string>"
+                 */
+                static std::string usage(std::string const& a_strPath) noexcept {
+                    std::string strUsage{ "Usage: " + a_strPath };
+                    char const* const aszNames[]{ Parser<typename std::decay<Args>::type>::name()... };
+                    for (char const* szName : aszNames) {
+                        strUsage += std::string(" <") + szName + ">";
+                    }
+                    return strUsage;
+                }
+
+                /**
+                 * @brief Parses and validates all the arguments, the errors are printed on the console and the command is
+                 *        marked as failed
+                 * @return bool     True if all the arguments are valid
+                 */
+                static bool parse(UserCommandData const& a_Data, Values& a_rValues) noexcept {
+                    if (sizeof...(Args) != a_Data.args.size()) {
+                        a_Data.console.printError("Expected " + std::to_string(sizeof...(Args)) + " argument(s), got " +
+                            std::to_string(a_Data.args.size()) + ". " + usage(a_Data.info.path));
+                        a_Data.fail();
+                        return false;
+                    }
+                    bool const bRes{ parse(a_Data, a_rValues, typename MakeIndices<sizeof...(Args)>::type{}) };
+                    if (!bRes) {
+                        a_Data.fail();
+                    }
+                    return bRes;
+                }
+
+                /**
+                 * @brief Proposes the choices of the argument being typed
+                 */
+                static std::vector<std::string> complete(UserCommandAutoCompleteData const& a_Data) noexcept {
+                    using ChoicesFunction = std::vector<std::string>(*)();
+                    ChoicesFunction const apfChoices[]{ &Parser<typename std::decay<Args>::type>::choices... };
+                    std::vector<std::string> vstrRes{};
+                    if (a_Data.args.size() < sizeof...(Args)) {
+                        for (auto const& strChoice : apfChoices[a_Data.args.size()]()) {
+                            if (0 == strChoice.compare(0, a_Data.partialArg.size(), a_Data.partialArg)) {
+                                vstrRes.push_back(strChoice);
+                            }
+                        }
+                    }
+                    return vstrRes;
+                }
+
+                /**
+                 * @brief Calls the function of the command with the parsed arguments
+                 */
+                template<typename F>
+                static void call(F const& a_Function, UserCommandData const& a_Data, Values& a_rValues) {
+                    call(typename WithData<F>::type{}, a_Function, a_Data, a_rValues, typename MakeIndices<sizeof...(Args)>::type{});
+                }
+
+            private:
+                template<size_t... I> struct Indices {};
+                template<size_t N, size_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+                template<size_t... I> struct MakeIndices<0, I...> { using type = Indices<I...>; };
+
+                /// Tells if the function takes the UserCommandData before the arguments
+                template<typename F>
+                struct WithData {
+                    template<typename G>
+                    static std::true_type test(decltype(std::declval<G const&>()(std::declval<UserCommandData const&>(), std::declval<Args&>()...))*);
+                    template<typename G>
+                    static std::false_type test(...);
+                    using type = decltype(test<F>(nullptr));
+                };
+
+                template<size_t... I>
+                static bool parse(UserCommandData const& a_Data, Values& a_rValues, Indices<I...>) noexcept {
+                    bool bRes{ true };
+                    bool const abParsed[]{ true, parseOne<I>(a_Data, a_rValues, bRes)... };
+                    (void)abParsed;
+                    return bRes;
+                }
+
+                template<size_t I>
+                static bool parseOne(UserCommandData const& a_Data, Values& a_rValues, bool& a_rbRes) noexcept {
+                    using T = typename std::tuple_element<I, Values>::type;
+                    // Only the first invalid argument is reported
+                    if (a_rbRes && !Parser<T>::parse(a_Data.args[I], std::get<I>(a_rValues))) {
+                        a_Data.console.printError("Argument " + std::to_string(I + 1) + ": '" + a_Data.args[I] + "' is not a valid " +
+                            Parser<T>::name() + ". " + usage(a_Data.info.path));
+                        a_rbRes = false;
+                    }
+                    return a_rbRes;
+                }
+
+                template<typename F, size_t... I>
+                static void call(std::true_type, F const& a_Function, UserCommandData const& a_Data, Values& a_rValues, Indices<I...>) {
+                    a_Function(a_Data, std::get<I>(a_rValues)...);
+                }
+
+                template<typename F, size_t... I>
+                static void call(std::false_type, F const& a_Function, UserCommandData const&, Values& a_rValues, Indices<I...>) {
+                    a_Function(std::get<I>(a_rValues)...);
+                }
+            };
+        }
+
+        template<typename Arg0, typename... Args, typename F>
+        void Console::addCommand(UserCommandInfo const& a_CommandInfo, F a_Function) noexcept {
+            using Command = arguments::TypedCommand<Arg0, Args...>;
+            UserCommandInfo info{ a_CommandInfo };
+            if (info.help.empty()) {
+                info.help = Command::usage(info.path);
+            }
+            addCommand(info, UserCommandFunctor1{ [a_Function](UserCommandData const& a_Data) {
+                typename Command::Values values{};
+                if (Command::parse(a_Data, values)) {
+                    Command::call(a_Function, a_Data, values);
+                }
+            } }, UserCommandAutoCompleteFunctor{ &Command::complete });
         }
 
     } // console
@@ -4,6 +4,13 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdlib>
+#include <cerrno>
+#include <cctype>
+#include <cmath>
 #if __cplusplus >= 201703L // >= C++17
 #include "impl/filesystem.hpp"
 namespace fs = std::filesystem;
@@ -22,6 +29,46 @@ namespace emb {
             return "0.1.0";
         }
 
+        struct CancellationToken::State {
+            atomic<bool> bCancelled{ false };
+            chrono::steady_clock::time_point deadline{ chrono::steady_clock::time_point::max() };
+            std::mutex mutex{};
+            condition_variable condition{};
+        };
+
+        CancellationToken::CancellationToken() noexcept : m_pState{ make_shared<State>() } {
+        }
+
+        CancellationToken::CancellationToken(chrono::milliseconds const a_Timeout) noexcept : m_pState{ make_shared<State>() } {
+            if (a_Timeout.count() > 0) {
+                m_pState->deadline = chrono::steady_clock::now() + a_Timeout;
+            }
+        }
+
+        bool CancellationToken::isCancelled() const noexcept {
+            // The timeout is checked lazily: no timer is needed to cancel the token
+            return m_pState->bCancelled.load(memory_order_acquire) ||
+                (chrono::steady_clock::time_point::max() != m_pState->deadline && chrono::steady_clock::now() >= m_pState->deadline);
+        }
+
+        bool CancellationToken::waitFor(chrono::milliseconds const a_Duration) const noexcept {
+            auto const until = min(chrono::steady_clock::now() + a_Duration, m_pState->deadline);
+            unique_lock<mutex> lock{ m_pState->mutex };
+            m_pState->condition.wait_until(lock, until, [this] { return m_pState->bCancelled.load(memory_order_acquire); });
+            return isCancelled();
+        }
+
+        bool CancellationToken::cancel() const noexcept {
+            bool bRes{ false };
+            {
+                lock_guard<mutex> const lock{ m_pState->mutex };
+                bRes = !isCancelled();
+                m_pState->bCancelled.store(true, memory_order_release);
+            }
+            m_pState->condition.notify_all();
+            return bRes;
+        }
+
         namespace autocompletion {
             // We need a custom getCanonicalPath function to use it on Windows and Unix
             string getCanonicalPath(std::string const& a_strPath, bool a_bEndWithDelimiter = true) {
@@ -233,6 +280,73 @@ namespace emb {
 
         } // autocompletion
 
+        namespace arguments {
+            namespace {
+                // strto* functions skip leading spaces and stop at the first invalid character, the whole argument is required here
+                bool isNumberCandidate(string const& a_strArg) noexcept {
+                    return !a_strArg.empty() && !isspace(static_cast<unsigned char>(a_strArg.front()));
+                }
+            }
+
+            bool parseSigned(string const& a_strArg, long long& a_rllValue) noexcept {
+                if (!isNumberCandidate(a_strArg)) {
+                    return false;
+                }
+                char* pEnd{ nullptr };
+                errno = 0;
+                long long const llValue{ strtoll(a_strArg.c_str(), &pEnd, 10) };
+                bool const bRes{ 0 == errno && a_strArg.c_str() + a_strArg.size() == pEnd };
+                if (bRes) {
+                    a_rllValue = llValue;
+                }
+                return bRes;
+            }
+
+            bool parseUnsigned(string const& a_strArg, unsigned long long& a_rullValue) noexcept {
+                // strtoull accepts negative values, and wraps them
+                if (!isNumberCandidate(a_strArg) || '-' == a_strArg.front()) {
+                    return false;
+                }
+                char* pEnd{ nullptr };
+                errno = 0;
+                unsigned long long const ullValue{ strtoull(a_strArg.c_str(), &pEnd, 10) };
+                bool const bRes{ 0 == errno && a_strArg.c_str() + a_strArg.size() == pEnd };
+                if (bRes) {
+                    a_rullValue = ullValue;
+                }
+                return bRes;
+            }
+
+            bool parseFloating(string const& a_strArg, long double& a_rldValue) noexcept {
+                if (!isNumberCandidate(a_strArg)) {
+                    return false;
+                }
+                char* pEnd{ nullptr };
+                errno = 0;
+                long double const ldValue{ strtold(a_strArg.c_str(), &pEnd) };
+                // An underflow gives a value close to 0, only an overflow is an error
+                bool const bRes{ (0 == errno || std::isfinite(ldValue)) && a_strArg.c_str() + a_strArg.size() == pEnd };
+                if (bRes) {
+                    a_rldValue = ldValue;
+                }
+                return bRes;
+            }
+
+            bool parseBool(string const& a_strArg, bool& a_rbValue) noexcept {
+                bool bRes{ true };
+                if ("true" == a_strArg || "1" == a_strArg || "yes" == a_strArg || "on" == a_strArg) {
+                    a_rbValue = true;
+                }
+                else if ("false" == a_strArg || "0" == a_strArg || "no" == a_strArg || "off" == a_strArg) {
+                    a_rbValue = false;
+                }
+                else {
+                    bRes = false;
+                }
+                return bRes;
+            }
+        } // arguments
+
         namespace table {
 
             void print(IPrintableConsole& a_rConsole, Table const& a_stTable) {
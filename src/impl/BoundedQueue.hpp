@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace emb {
+    namespace tools {
+        /**
+         * @brief Bounded lock-free queue (Dmitry Vyukov's algorithm). Any number of producers and consumers may use it
+         *        concurrently; claiming a slot costs a single compare-and-swap.
+         *        Values are exchanged with the slots instead of being copied, so that a producer gets back the (emptied)
+         *        value previously stored in the slot and can reuse its memory.
+         * @tparam T    Type of the stored values, must be default-constructible and swappable
+         */
+        template<typename T>
+        class BoundedQueue {
+        public:
+            /**
+             * @brief Creates the queue
+             * @param a_ulCapacity  Maximum number of values stored, must be a power of 2
+             */
+            explicit BoundedQueue(size_t a_ulCapacity) noexcept
+                : m_pCells{ new Cell[a_ulCapacity] }
+                , m_ulMask{ a_ulCapacity - 1 } {
+                assert(a_ulCapacity >= 2 && 0 == (a_ulCapacity & m_ulMask));
+                for (size_t i = 0; i < a_ulCapacity; ++i) {
+                    m_pCells[i].ulSequence.store(i, std::memory_order_relaxed);
+                }
+            }
+            BoundedQueue(BoundedQueue const&) = delete;
+            BoundedQueue& operator= (BoundedQueue const&) = delete;
+
+            size_t capacity() const noexcept { return m_ulMask + 1; }
+
+            /**
+             * @brief Tries to push a value
+             * @param a_rValue  Value to push. On success, it is exchanged with the content of the free slot.
+             * @return true     If the value has been pushed
+             * @return false    If the queue is full
+             */
+            bool tryPush(T& a_rValue) noexcept {
+                Cell* pCell{ nullptr };
+                size_t ulPos{ m_ulEnqueuePos.load(std::memory_order_relaxed) };
+                for (;;) {
+                    pCell = &m_pCells[ulPos & m_ulMask];
+                    intptr_t const lDiff{ static_cast<intptr_t>(pCell->ulSequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(ulPos) };
+                    if (0 == lDiff) {
+                        if (m_ulEnqueuePos.compare_exchange_weak(ulPos, ulPos + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    }
+                    else if (lDiff < 0) {
+                        return false;
+                    }
+                    else {
+                        ulPos = m_ulEnqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+                using std::swap;
+                swap(pCell->value, a_rValue);
+                pCell->ulSequence.store(ulPos + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * @brief Tries to pop a value
+             * @param a_rValue  Receives the popped value. On success, its previous content is left in the released slot.
+             * @return true     If a value has been popped
+             * @return false    If the queue is empty
+             */
+            bool tryPop(T& a_rValue) noexcept {
+                Cell* pCell{ nullptr };
+                size_t ulPos{ m_ulDequeuePos.load(std::memory_order_relaxed) };
+                for (;;) {
+                    pCell = &m_pCells[ulPos & m_ulMask];
+                    intptr_t const lDiff{ static_cast<intptr_t>(pCell->ulSequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(ulPos + 1) };
+                    if (0 == lDiff) {
+                        if (m_ulDequeuePos.compare_exchange_weak(ulPos, ulPos + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    }
+                    else if (lDiff < 0) {
+                        return false;
+                    }
+                    else {
+                        ulPos = m_ulDequeuePos.load(std::memory_order_relaxed);
+                    }
+                }
+                using std::swap;
+                swap(pCell->value, a_rValue);
+                pCell->ulSequence.store(ulPos + m_ulMask + 1, std::memory_order_release);
+                return true;
+            }
+
+        private:
+            struct Cell {
+                std::atomic<size_t> ulSequence{ 0 };
+                T value{};
+            };
+
+        private:
+            std::unique_ptr<Cell[]> m_pCells;
+            size_t const m_ulMask;
+            // Keeps producers and consumers positions on separate cache lines
+            char m_Padding0[64]{};
+            std::atomic<size_t> m_ulEnqueuePos{ 0 };
+            char m_Padding1[64]{};
+            std::atomic<size_t> m_ulDequeuePos{ 0 };
+            char m_Padding2[64]{};
+        };
+    } // tools
+} // emb
@@ -0,0 +1,163 @@
+#include "CommandHistory.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cerrno>
+#ifdef unix
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace emb {
+    namespace console {
+        using namespace std;
+
+        static size_t const s_ulMinCapacity{ 1 };
+        static size_t const s_ulMaxFileRatio{ 2 };  ///< The file is rewritten when it has this many times more entries than the history
+
+        CommandHistory::CommandHistory(OptionHistory const& a_Option) noexcept
+            : m_vEntries(max(a_Option.ulCapacity, s_ulMinCapacity))
+            , m_strFilePath{ a_Option.strFilePath } {
+            if (!m_strFilePath.empty()) {
+                load();
+#ifdef unix
+                // Like a shell history, the file may contain secrets typed by the user
+                m_iFile = open(m_strFilePath.c_str(), O_CREAT | O_APPEND | O_WRONLY | O_CLOEXEC, 0600);
+#else
+                m_File.open(m_strFilePath, ios::out | ios::app);
+#endif
+            }
+        }
+
+        CommandHistory::~CommandHistory() noexcept {
+#ifdef unix
+            if (m_iFile >= 0) {
+                close(m_iFile);
+            }
+#endif
+        }
+
+        void CommandHistory::add(string const& a_strEntry) noexcept {
+            if (a_strEntry.empty()) {
+                return;
+            }
+            lock_guard<mutex> const lock{ m_Mutex };
+            push(a_strEntry);
+            // An entry is a single line: a line break would split it in the file
+            if (string::npos != a_strEntry.find_first_of("\r\n")) {
+                return;
+            }
+#ifdef unix
+            if (m_iFile >= 0) {
+                // A single write: the line is appended at once, even if other processes append to the file
+                string const strLine{ a_strEntry + '\n' };
+                ssize_t const written{ write(m_iFile, strLine.data(), strLine.size()) };
+                (void)written;
+            }
+#else
+            if (m_File.is_open()) {
+                m_File << a_strEntry << '\n';
+                m_File.flush();
+            }
+#endif
+        }
+
+        size_t CommandHistory::size() const noexcept {
+            lock_guard<mutex> const lock{ m_Mutex };
+            return m_ulSize;
+        }
+
+        size_t CommandHistory::count() const noexcept {
+            lock_guard<mutex> const lock{ m_Mutex };
+            return m_ulCount;
+        }
+
+        string CommandHistory::get(size_t const a_ulAge) const noexcept {
+            lock_guard<mutex> const lock{ m_Mutex };
+            return a_ulAge < m_ulSize ? at(a_ulAge).strText : string{};
+        }
+
+        size_t CommandHistory::search(string const& a_strText, size_t const a_ulFromAge) const noexcept {
+            uint64_t const ulCharacters{ getCharacters(a_strText) };
+            lock_guard<mutex> const lock{ m_Mutex };
+            for (size_t ulAge = a_ulFromAge; ulAge < m_ulSize; ++ulAge) {
+                Entry const& entry = at(ulAge);
+                // Most entries lack one of the characters: their text is not even read
+                if (ulCharacters == (entry.ulCharacters & ulCharacters) && string::npos != entry.strText.find(a_strText)) {
+                    return ulAge;
+                }
+            }
+            return string::npos;
+        }
+
+        uint64_t CommandHistory::getCharacters(string const& a_strText) noexcept {
+            uint64_t ulCharacters{ 0 };
+            for (char const c : a_strText) {
+                ulCharacters |= uint64_t{ 1 } << (static_cast<unsigned char>(c) % 64);
+            }
+            return ulCharacters;
+        }
+
+        void CommandHistory::load() noexcept {
+            size_t ulNbLines{ 0 };
+            {
+                ifstream file{ m_strFilePath };
+                string strLine{};
+                while (getline(file, strLine)) {
+                    if (!strLine.empty()) {
+                        push(strLine);
+                        ++ulNbLines;
+                    }
+                }
+            }
+            if (ulNbLines > s_ulMaxFileRatio * m_vEntries.size()) {
+                // Only the entries kept are written back, the file is replaced at once
+                string const strTmpFilePath{ m_strFilePath + ".tmp" };
+                string strContent{};
+                for (size_t ulAge = m_ulSize; ulAge > 0; --ulAge) {
+                    strContent += at(ulAge - 1).strText;
+                    strContent += '\n';
+                }
+                if (!writeFile(strTmpFilePath, strContent) || 0 != rename(strTmpFilePath.c_str(), m_strFilePath.c_str())) {
+                    remove(strTmpFilePath.c_str());
+                }
+            }
+        }
+
+        void CommandHistory::push(string const& a_strEntry) noexcept {
+            Entry& rEntry = m_vEntries[m_ulNext];
+            // The slot keeps the memory of the entry it replaces
+            rEntry.strText.assign(a_strEntry);
+            rEntry.ulCharacters = getCharacters(a_strEntry);
+            m_ulNext = (m_ulNext + 1) % m_vEntries.size();
+            m_ulSize = min(m_ulSize + 1, m_vEntries.size());
+            ++m_ulCount;
+        }
+
+        bool CommandHistory::writeFile(string const& a_strFilePath, string const& a_strContent) noexcept {
+#ifdef unix
+            int const iFile{ open(a_strFilePath.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0600) };
+            if (iFile < 0) {
+                return false;
+            }
+            size_t ulWritten{ 0 };
+            while (ulWritten < a_strContent.size()) {
+                ssize_t const written{ write(iFile, a_strContent.data() + ulWritten, a_strContent.size() - ulWritten) };
+                if (written < 0 && EINTR != errno) {
+                    break;
+                }
+                ulWritten += written > 0 ? static_cast<size_t>(written) : 0;
+            }
+            return 0 == close(iFile) && ulWritten == a_strContent.size();
+#else
+            ofstream file{ a_strFilePath, ios::out | ios::trunc };
+            file << a_strContent;
+            file.close();
+            return !file.fail();
+#endif
+        }
+
+        CommandHistory::Entry const& CommandHistory::at(size_t const a_ulAge) const noexcept {
+            return m_vEntries[(m_ulNext + m_vEntries.size() - 1 - a_ulAge) % m_vEntries.size()];
+        }
+    } // console
+} // emb
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "EmbConsole.hpp"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include <cstdint>
+
+namespace emb {
+    namespace console {
+        /**
+         * @brief Entries typed by the users, shared by all the terminals.
+         *        The entries are kept in a ring buffer allocated once: adding an entry never moves the others, the oldest
+         *        one being overwritten when the history is full. They are appended to a file, if any, from which the
+         *        history is read back at start. Each entry is indexed by the characters it contains, so that a search
+         *        only compares the text of the entries that may contain it.
+         */
+        class CommandHistory {
+        public:
+            /**
+             * @brief Creates the history, read from its file if any
+             * @param a_Option  Capacity and file of the history
+             */
+            explicit CommandHistory(OptionHistory const& a_Option) noexcept;
+            CommandHistory(CommandHistory const&) = delete;
+            CommandHistory(CommandHistory&&) = delete;
+            ~CommandHistory() noexcept;
+            CommandHistory& operator= (CommandHistory const&) = delete;
+            CommandHistory& operator= (CommandHistory&&) = delete;
+
+            /**
+             * @brief Adds an entry as the most recent one, and appends it to the file
+             * @param a_strEntry    Entry, ignored if empty
+             */
+            void add(std::string const& a_strEntry) noexcept;
+            /**
+             * @brief Gives the number of entries
+             */
+            size_t size() const noexcept;
+            /**
+             * @brief Gives the number of entries added since the history was created, including the ones read from the
+             *        file. Its variation tells how much older an entry became.
+             */
+            size_t count() const noexcept;
+            /**
+             * @brief Gives an entry
+             * @param a_ulAge   0 for the most recent entry, must be lower than size()
+             */
+            std::string get(size_t const a_ulAge) const noexcept;
+            /**
+             * @brief Searches the most recent entry containing a text, from a given entry to the oldest one
+             * @param a_strText     Text to search, an empty text matches any entry
+             * @param a_ulFromAge   Age of the first entry checked
+             * @return size_t       Age of the entry found, std::string::npos if none
+             */
+            size_t search(std::string const& a_strText, size_t const a_ulFromAge) const noexcept;
+
+        private:
+            struct Entry {
+                std::string strText{};
+                uint64_t ulCharacters{ 0 };     ///< One bit by character (modulo 64) found in the text
+            };
+
+        private:
+            static uint64_t getCharacters(std::string const& a_strText) noexcept;
+            /**
+             * @brief Reads the entries of the file. The file is rewritten with the entries kept when it became much bigger
+             *        than the history.
+             */
+            void load() noexcept;
+            void push(std::string const& a_strEntry) noexcept;
+            /**
+             * @brief Writes the whole content of a file, which is created readable by the user only
+             */
+            static bool writeFile(std::string const& a_strFilePath, std::string const& a_strContent) noexcept;
+            Entry const& at(size_t const a_ulAge) const noexcept;
+
+        private:
+            mutable std::mutex m_Mutex{};
+            std::vector<Entry> m_vEntries;      ///< Ring buffer, its size is the capacity of the history
+            size_t m_ulNext{ 0 };               ///< Slot of the next entry added
+            size_t m_ulSize{ 0 };
+            size_t m_ulCount{ 0 };              ///< Entries added since the creation
+            std::string const m_strFilePath;
+            /// Opened in append mode, so that several processes can share the file, and readable by the user only
+#ifdef unix
+            int m_iFile{ -1 };
+#else
+            std::ofstream m_File{};
+#endif
+        };
+    } // console
+} // emb
@@ -0,0 +1,118 @@
+#include "CommandMetrics.hpp"
+#include <algorithm>
+
+namespace emb {
+    namespace console {
+        using namespace std;
+
+        array<chrono::microseconds, 5> const CommandMetrics::s_aBucketBounds{ {
+            chrono::milliseconds{ 1 },
+            chrono::milliseconds{ 10 },
+            chrono::milliseconds{ 100 },
+            chrono::seconds{ 1 },
+            chrono::seconds{ 10 }
+        } };
+
+        namespace {
+            atomic<size_t> s_ulNextStripe{ 0 };
+            /// Stripe used by the calling thread, the threads being spread over the stripes in turn
+            thread_local size_t const t_ulStripe{ s_ulNextStripe++ };
+        }
+
+        CommandMetrics::Counters::Stripe& CommandMetrics::Counters::stripe() noexcept {
+            return m_aStripes[t_ulStripe % s_ulNbStripes];
+        }
+
+        void CommandMetrics::Counters::recordCall(bool const a_bFailed) noexcept {
+            Stripe& rStripe = stripe();
+            rStripe.ulCalls.fetch_add(1, memory_order_relaxed);
+            if (a_bFailed) {
+                rStripe.ulFailures.fetch_add(1, memory_order_relaxed);
+            }
+        }
+
+        void CommandMetrics::Counters::recordEnd(chrono::microseconds const a_Duration, bool const a_bFailed) noexcept {
+            Stripe& rStripe = stripe();
+            uint64_t const ulUs{ static_cast<uint64_t>(max<chrono::microseconds::rep>(0, a_Duration.count())) };
+            if (a_bFailed) {
+                rStripe.ulFailures.fetch_add(1, memory_order_relaxed);
+            }
+            rStripe.ulTotalUs.fetch_add(ulUs, memory_order_relaxed);
+            uint64_t ulMaxUs{ rStripe.ulMaxUs.load(memory_order_relaxed) };
+            while (ulUs > ulMaxUs && !rStripe.ulMaxUs.compare_exchange_weak(ulMaxUs, ulUs, memory_order_relaxed)) {
+            }
+            size_t const ulBucket{ static_cast<size_t>(upper_bound(s_aBucketBounds.begin(), s_aBucketBounds.end(), a_Duration) - s_aBucketBounds.begin()) };
+            rStripe.aulBuckets[ulBucket].fetch_add(1, memory_order_relaxed);
+        }
+
+        CommandMetrics::Stats CommandMetrics::Counters::get() const noexcept {
+            Stats stats{};
+            uint64_t ulTotalUs{ 0 };
+            uint64_t ulMaxUs{ 0 };
+            for (Stripe const& rStripe : m_aStripes) {
+                stats.ulCalls += rStripe.ulCalls.load(memory_order_relaxed);
+                stats.ulFailures += rStripe.ulFailures.load(memory_order_relaxed);
+                ulTotalUs += rStripe.ulTotalUs.load(memory_order_relaxed);
+                ulMaxUs = max(ulMaxUs, rStripe.ulMaxUs.load(memory_order_relaxed));
+                for (size_t i = 0; i < s_ulNbBuckets; ++i) {
+                    stats.aulBuckets[i] += rStripe.aulBuckets[i].load(memory_order_relaxed);
+                }
+            }
+            stats.totalDuration = chrono::microseconds{ ulTotalUs };
+            stats.maxDuration = chrono::microseconds{ ulMaxUs };
+            return stats;
+        }
+
+        void CommandMetrics::Counters::reset() noexcept {
+            for (Stripe& rStripe : m_aStripes) {
+                rStripe.ulCalls.store(0, memory_order_relaxed);
+                rStripe.ulFailures.store(0, memory_order_relaxed);
+                rStripe.ulTotalUs.store(0, memory_order_relaxed);
+                rStripe.ulMaxUs.store(0, memory_order_relaxed);
+                for (auto& rulBucket : rStripe.aulBuckets) {
+                    rulBucket.store(0, memory_order_relaxed);
+                }
+            }
+        }
+
+        CommandMetrics::CommandMetrics() noexcept
+            : m_pCounters{ make_shared<MCounters const>() } {
+        }
+
+        CommandMetrics::CountersPtr CommandMetrics::get(string const& a_strPath) noexcept {
+            {
+                auto const pCounters = atomic_load(&m_pCounters);
+                auto const it = pCounters->find(a_strPath);
+                if (pCounters->end() != it) {
+                    return it->second;
+                }
+            }
+            // First call of the command: the counters are created once, the map being copied
+            lock_guard<mutex> const lock{ m_WriteMutex };
+            auto const pCounters = atomic_load(&m_pCounters);
+            auto const it = pCounters->find(a_strPath);
+            if (pCounters->end() != it) {
+                return it->second;
+            }
+            auto pNewCounters = make_shared<MCounters>(*pCounters);
+            CountersPtr pCommandCounters{ make_shared<Counters>() };
+            pNewCounters->emplace(a_strPath, pCommandCounters);
+            atomic_store(&m_pCounters, shared_ptr<MCounters const>{ std::move(pNewCounters) });
+            return pCommandCounters;
+        }
+
+        CommandMetrics::MStats CommandMetrics::getStats() const noexcept {
+            MStats mapStats{};
+            for (auto const& elm : *atomic_load(&m_pCounters)) {
+                mapStats.emplace(elm.first, elm.second->get());
+            }
+            return mapStats;
+        }
+
+        void CommandMetrics::reset() noexcept {
+            for (auto const& elm : *atomic_load(&m_pCounters)) {
+                elm.second->reset();
+            }
+        }
+    } // console
+} // emb
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace emb {
+    namespace console {
+        /**
+         * @brief Execution counters of the commands, by command path.
+         *        The counters of a command are split in stripes, each thread writing to its own stripe with relaxed atomic
+         *        operations: recording never takes a lock and the threads running commands do not share cache lines. The
+         *        counters of a path are created once, then found in an immutable snapshot without any lock.
+         */
+        class CommandMetrics {
+        public:
+            /// Upper bounds of the latency buckets, the last bucket has no upper bound
+            static std::array<std::chrono::microseconds, 5> const s_aBucketBounds;
+            static size_t const s_ulNbBuckets{ 6 };
+
+            /**
+             * @brief Counters of a command, summed over all the threads
+             */
+            struct Stats {
+                uint64_t ulCalls{ 0 };          ///< Commands started, or refused
+                uint64_t ulFailures{ 0 };       ///< Commands refused because too many were running, cancelled, or failed
+                std::chrono::microseconds totalDuration{ 0 };   ///< Sum of the durations of the commands that ended
+                std::chrono::microseconds maxDuration{ 0 };
+                std::array<uint64_t, s_ulNbBuckets> aulBuckets{};   ///< Commands that ended, by duration
+            };
+            using MStats = std::map<std::string, Stats>;
+
+            /**
+             * @brief Counters of a command, to be kept by the caller for as long as it records
+             */
+            class Counters {
+                friend class CommandMetrics;
+            public:
+                /**
+                 * @brief Records a command that ended
+                 * @param a_Duration    Execution duration of the command
+                 * @param a_bFailed     True if the command failed (e.g. it was cancelled, or called UserCommandData::fail())
+                 */
+                void recordEnd(std::chrono::microseconds const a_Duration, bool const a_bFailed) noexcept;
+                /**
+                 * @brief Records a command that is started, or refused
+                 * @param a_bFailed     True if the command is refused
+                 */
+                void recordCall(bool const a_bFailed) noexcept;
+
+            private:
+                static size_t const s_ulNbStripes{ 8 };
+                static size_t const s_ulCacheLineSize{ 64 };
+                /// Padded rather than aligned: the counters are allocated by make_shared, which ignores over-alignment in C++14
+                struct Stripe {
+                    std::atomic<uint64_t> ulCalls{ 0 };
+                    std::atomic<uint64_t> ulFailures{ 0 };
+                    std::atomic<uint64_t> ulTotalUs{ 0 };
+                    std::atomic<uint64_t> ulMaxUs{ 0 };
+                    std::array<std::atomic<uint64_t>, s_ulNbBuckets> aulBuckets{};
+                    char acPadding[s_ulCacheLineSize];  ///< A whole line between the counters of two stripes, whatever the address
+                };
+
+            private:
+                Stripe& stripe() noexcept;
+                Stats get() const noexcept;
+                void reset() noexcept;
+
+            private:
+                std::array<Stripe, s_ulNbStripes> m_aStripes{};
+            };
+            using CountersPtr = std::shared_ptr<Counters>;
+
+        public:
+            CommandMetrics() noexcept;
+            CommandMetrics(CommandMetrics const&) = delete;
+            CommandMetrics(CommandMetrics&&) = delete;
+            ~CommandMetrics() noexcept = default;
+            CommandMetrics& operator= (CommandMetrics const&) = delete;
+            CommandMetrics& operator= (CommandMetrics&&) = delete;
+
+            /**
+             * @brief Gives the counters of a command, created on the first call for its path
+             * @param a_strPath     Canonical path of the command
+             */
+            CountersPtr get(std::string const& a_strPath) noexcept;
+            /**
+             * @brief Gives the counters of all the commands recorded, by path
+             */
+            MStats getStats() const noexcept;
+            /**
+             * @brief Sets all the counters to 0
+             */
+            void reset() noexcept;
+
+        private:
+            using MCounters = std::map<std::string, CountersPtr>;
+
+        private:
+            std::mutex m_WriteMutex{};                  ///< Serializes the creation of counters, never taken to record
+            std::shared_ptr<MCounters const> m_pCounters;   ///< Only accessed with the atomic shared_ptr functions
+        };
+    } // console
+} // emb
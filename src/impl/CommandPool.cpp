@@ -0,0 +1,93 @@
+#include "CommandPool.hpp"
+
+namespace emb {
+    namespace console {
+        using namespace std;
+
+        CommandPool::CommandPool(size_t a_ulMaxWorkers, size_t a_ulMaxPending) noexcept
+            : m_ulMaxWorkers{ a_ulMaxWorkers > 0 ? a_ulMaxWorkers : 1 }
+            , m_ulMaxPending{ a_ulMaxPending }
+            , m_pShared{ make_shared<Shared>() } {
+        }
+
+        CommandPool::~CommandPool() noexcept {
+            stop();
+        }
+
+        void CommandPool::stop() noexcept {
+            {
+                lock_guard<mutex> const lock{ m_pShared->mutex };
+                m_pShared->bStop = true;
+            }
+            m_pShared->condition.notify_all();
+            for (auto& worker : m_vWorkers) {
+                if (this_thread::get_id() == worker.get_id()) {
+                    worker.detach();
+                }
+                else {
+                    worker.join();
+                }
+            }
+            m_vWorkers.clear();
+        }
+
+        bool CommandPool::post(Task a_Task, CancellationToken const& a_Cancellation) noexcept {
+            {
+                lock_guard<mutex> const lock{ m_pShared->mutex };
+                if (m_pShared->bStop || m_pShared->dqJobs.size() >= m_ulMaxPending + m_pShared->ulIdleWorkers) {
+                    return false;
+                }
+                m_pShared->dqJobs.push_back(Job{ std::move(a_Task), a_Cancellation });
+                // A new worker is only started when all the existing ones are busy
+                if (m_pShared->dqJobs.size() > m_pShared->ulIdleWorkers && m_vWorkers.size() < m_ulMaxWorkers) {
+                    m_vWorkers.emplace_back(&CommandPool::workerLoop, m_pShared);
+                    ++m_pShared->ulIdleWorkers;
+                }
+            }
+            m_pShared->condition.notify_one();
+            return true;
+        }
+
+        void CommandPool::cancelAll() noexcept {
+            lock_guard<mutex> const lock{ m_pShared->mutex };
+            for (Job const& job : m_pShared->dqJobs) {
+                job.cancellation.cancel();
+            }
+            for (CancellationToken const& cancellation : m_pShared->lRunning) {
+                cancellation.cancel();
+            }
+        }
+
+        bool CommandPool::busy() const noexcept {
+            lock_guard<mutex> const lock{ m_pShared->mutex };
+            return !m_pShared->dqJobs.empty() || !m_pShared->lRunning.empty();
+        }
+
+        void CommandPool::workerLoop(shared_ptr<Shared> a_pShared) noexcept {
+            unique_lock<mutex> lock{ a_pShared->mutex };
+            for (;;) {
+                a_pShared->condition.wait(lock, [&a_pShared] { return a_pShared->bStop || !a_pShared->dqJobs.empty(); });
+                if (a_pShared->dqJobs.empty()) {
+                    // Stopped, and nothing left to run
+                    break;
+                }
+                Task task{ std::move(a_pShared->dqJobs.front().task) };
+                auto const itRunning = a_pShared->lRunning.insert(a_pShared->lRunning.end(), a_pShared->dqJobs.front().cancellation);
+                a_pShared->dqJobs.pop_front();
+                --a_pShared->ulIdleWorkers;
+                lock.unlock();
+                // The commands report their own exceptions, whatever escapes must not end the process
+                try {
+                    task();
+                }
+                catch (...) {
+                }
+                // The command (and what it captured) is released before the worker waits again
+                task = nullptr;
+                lock.lock();
+                a_pShared->lRunning.erase(itRunning);
+                ++a_pShared->ulIdleWorkers;
+            }
+        }
+    } // console
+} // emb
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "EmbConsole.hpp"
+#include <functional>
+#include <deque>
+#include <list>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstddef>
+
+namespace emb {
+    namespace console {
+        /**
+         * @brief Bounded pool of worker threads running the user commands.
+         *        Workers are started on demand, up to a maximum, and then kept waiting for the next command, so that running a
+         *        command does not cost a thread creation. Posting a command never waits for a running one.
+         */
+        class CommandPool {
+        public:
+            using Task = std::function<void(void)>;
+
+        public:
+            /**
+             * @brief Creates the pool, without starting any worker
+             * @param a_ulMaxWorkers    Maximum number of commands running concurrently
+             * @param a_ulMaxPending    Maximum number of commands waiting for a free worker
+             */
+            CommandPool(size_t a_ulMaxWorkers, size_t a_ulMaxPending) noexcept;
+            CommandPool(CommandPool const&) = delete;
+            CommandPool(CommandPool&&) = delete;
+            /**
+             * @brief Stops the pool, see stop()
+             */
+            ~CommandPool() noexcept;
+            CommandPool& operator= (CommandPool const&) = delete;
+            CommandPool& operator= (CommandPool&&) = delete;
+
+            /**
+             * @brief Queues a command, started as soon as a worker is free
+             * @param a_Task            Command to run
+             * @param a_Cancellation    Token of the command, cancelled by cancelAll()
+             * @return bool             False if too many commands are already waiting, or if the pool is stopped
+             */
+            bool post(Task a_Task, CancellationToken const& a_Cancellation = CancellationToken{}) noexcept;
+            /**
+             * @brief Cancels the tokens of all the commands waiting or running
+             */
+            void cancelAll() noexcept;
+            /**
+             * @brief Tells if commands are waiting or running
+             */
+            bool busy() const noexcept;
+            /**
+             * @brief Refuses the next commands, runs the commands still waiting, then waits for all the workers to end.
+             *        When the pool is stopped by one of its own commands (which owned the last reference to the console),
+             *        that worker is detached instead and ends on its own.
+             */
+            void stop() noexcept;
+
+        private:
+            /// State shared with the workers, which may outlive the pool
+            struct Job {
+                Task task{};
+                CancellationToken cancellation{};
+            };
+            struct Shared {
+                std::mutex mutex{};
+                std::condition_variable condition{};
+                std::deque<Job> dqJobs{};
+                std::list<CancellationToken> lRunning{};    ///< Tokens of the commands running
+                size_t ulIdleWorkers{ 0 };
+                bool bStop{ false };
+            };
+
+        private:
+            static void workerLoop(std::shared_ptr<Shared> a_pShared) noexcept;
+
+        private:
+            size_t const m_ulMaxWorkers;
+            size_t const m_ulMaxPending;
+            std::shared_ptr<Shared> m_pShared;
+            std::vector<std::thread> m_vWorkers{};
+        };
+    } // console
+} // emb
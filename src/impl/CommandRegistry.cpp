@@ -0,0 +1,136 @@
+#include "CommandRegistry.hpp"
+#include <atomic>
+#include <set>
+
+namespace emb {
+    namespace console {
+        using namespace std;
+
+        namespace {
+            /**
+             * @brief Nodes being modified by a change to the registry, before it is published
+             */
+            class Change {
+            public:
+                /**
+                 * @brief Gives a node that can be modified in place of a published one, created or copied only once per change
+                 * @param a_rpNode  Published node, nullptr to create one. Replaced by the node given.
+                 */
+                CommandRegistry::Node* modify(CommandRegistry::NodePtr& a_rpNode) noexcept {
+                    if (a_rpNode && m_setNodes.end() != m_setNodes.find(a_rpNode.get())) {
+                        // Created by this change, not published yet: nobody else can see it
+                        return const_cast<CommandRegistry::Node*>(a_rpNode.get());
+                    }
+                    auto pNode = a_rpNode ? make_shared<CommandRegistry::Node>(*a_rpNode) : make_shared<CommandRegistry::Node>();
+                    m_setNodes.insert(pNode.get());
+                    a_rpNode = pNode;
+                    return pNode.get();
+                }
+
+            private:
+                set<CommandRegistry::Node const*> m_setNodes{};
+            };
+        }
+
+        CommandRegistry::CommandPtr CommandRegistry::Snapshot::find(string const& a_strCanonicalPath) const noexcept {
+            Node const* pNode = findNode(a_strCanonicalPath);
+            return nullptr != pNode ? pNode->pCommand : nullptr;
+        }
+
+        CommandRegistry::Node const* CommandRegistry::Snapshot::findNode(string const& a_strCanonicalPath) const noexcept {
+            Node const* pNode = m_pRoot.get();
+            string strElement{};
+            forEachPathElement(a_strCanonicalPath, [&](size_t const a_ulPos, size_t const a_ulSize) {
+                strElement.assign(a_strCanonicalPath, a_ulPos, a_ulSize);
+                auto const it = pNode->mapChildren.find(strElement);
+                pNode = pNode->mapChildren.end() != it ? it->second.get() : nullptr;
+                return nullptr != pNode;
+            });
+            return pNode;
+        }
+
+        CommandRegistry::MCommands CommandRegistry::Snapshot::commands() const noexcept {
+            MCommands mapCommands{};
+            vector<pair<string, Node const*>> vToVisit{ { "", m_pRoot.get() } };
+            while (!vToVisit.empty()) {
+                auto const visited = vToVisit.back();
+                vToVisit.pop_back();
+                if (visited.second->pCommand) {
+                    mapCommands.emplace(visited.first, visited.second->pCommand);
+                }
+                for (auto const& elm : visited.second->mapChildren) {
+                    vToVisit.emplace_back(visited.first + "/" + elm.first, elm.second.get());
+                }
+            }
+            return mapCommands;
+        }
+
+        CommandRegistry::CommandRegistry() noexcept
+            : m_pSnapshot{ make_shared<Snapshot const>() } {
+        }
+
+        CommandRegistry::SnapshotPtr CommandRegistry::get() const noexcept {
+            return atomic_load(&m_pSnapshot);
+        }
+
+        void CommandRegistry::add(vector<UserCommand> const& a_vCommands) noexcept {
+            lock_guard<mutex> const lock{ m_WriteMutex };
+            Change change{};
+            NodePtr pRoot{ get()->m_pRoot };
+            Node* pNewRoot = change.modify(pRoot);
+            for (UserCommand const& command : a_vCommands) {
+                Node* pNode = pNewRoot;
+                forEachPathElement(command.info.path, [&](size_t const a_ulPos, size_t const a_ulSize) {
+                    pNode = change.modify(pNode->mapChildren[command.info.path.substr(a_ulPos, a_ulSize)]);
+                    return true;
+                });
+                pNode->pCommand = make_shared<UserCommand const>(command);
+            }
+            publish(std::move(pRoot));
+        }
+
+        bool CommandRegistry::del(string const& a_strPath) noexcept {
+            lock_guard<mutex> const lock{ m_WriteMutex };
+            NodePtr pRoot{ get()->m_pRoot };
+            // Names of the elements from the root to the command, checked before anything is copied
+            vector<string> vstrElements{};
+            Node const* pNode = pRoot.get();
+            forEachPathElement(a_strPath, [&](size_t const a_ulPos, size_t const a_ulSize) {
+                vstrElements.push_back(a_strPath.substr(a_ulPos, a_ulSize));
+                auto const it = pNode->mapChildren.find(vstrElements.back());
+                pNode = pNode->mapChildren.end() != it ? it->second.get() : nullptr;
+                return nullptr != pNode;
+            });
+            if (nullptr == pNode || !pNode->pCommand) {
+                return false;
+            }
+
+            Change change{};
+            vector<Node*> vNodes{ change.modify(pRoot) };
+            for (string const& strElement : vstrElements) {
+                vNodes.push_back(change.modify(vNodes.back()->mapChildren[strElement]));
+            }
+            vNodes.back()->pCommand = nullptr;
+            // The folders left without any command are removed, from the command to the root
+            for (size_t i = vstrElements.size(); i > 0; --i) {
+                if (vNodes[i]->pCommand || !vNodes[i]->mapChildren.empty()) {
+                    break;
+                }
+                vNodes[i - 1]->mapChildren.erase(vstrElements[i - 1]);
+            }
+            publish(std::move(pRoot));
+            return true;
+        }
+
+        void CommandRegistry::clear() noexcept {
+            lock_guard<mutex> const lock{ m_WriteMutex };
+            publish(make_shared<Node const>());
+        }
+
+        void CommandRegistry::publish(NodePtr a_pRoot) noexcept {
+            auto pSnapshot = make_shared<Snapshot>();
+            pSnapshot->m_pRoot = std::move(a_pRoot);
+            atomic_store(&m_pSnapshot, SnapshotPtr{ std::move(pSnapshot) });
+        }
+    } // console
+} // emb
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "EmbConsole.hpp"
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace emb {
+    namespace console {
+        /**
+         * @brief Registry of commands, published as immutable snapshots.
+         *        Readers take the current snapshot and use it without any lock for as long as they need, a change to the
+         *        registry copies the folders it modifies, from the command to the root, and publishes the new root
+         *        (copy-on-write). Everything else, commands included, is shared with the previous snapshots.
+         */
+        class CommandRegistry {
+        public:
+            using CommandPtr = std::shared_ptr<UserCommand const>;
+            using MCommands = std::map<std::string, CommandPtr>;
+
+            /**
+             * @brief Element of the command index, the commands being indexed by the elements of their path.
+             *        A node is a command, a folder (if it has children), or both.
+             */
+            struct Node {
+                std::map<std::string, std::shared_ptr<Node const>> mapChildren{};  ///< Elements of the folder, sorted by name
+                CommandPtr pCommand{};                                              ///< Command of this path, nullptr if none
+            };
+            using NodePtr = std::shared_ptr<Node const>;
+
+            /**
+             * @brief State of the registry at a given time, never modified once published
+             */
+            class Snapshot {
+                friend class CommandRegistry;
+            public:
+                /**
+                 * @brief Gives a command from its canonical path
+                 * @return CommandPtr   Command found, nullptr if none
+                 */
+                CommandPtr find(std::string const& a_strCanonicalPath) const noexcept;
+                /**
+                 * @brief Gives the node of a path in the index
+                 * @param a_strCanonicalPath    Canonical path to search
+                 * @return Node const*  Node found, nullptr if no command has this path or is under it
+                 */
+                Node const* findNode(std::string const& a_strCanonicalPath) const noexcept;
+                /**
+                 * @brief Gives the root folder of the index
+                 */
+                Node const& root() const noexcept { return *m_pRoot; }
+                /**
+                 * @brief Gives all the commands, sorted by path. The whole index is walked through.
+                 */
+                MCommands commands() const noexcept;
+
+            private:
+                NodePtr m_pRoot{ std::make_shared<Node const>() };
+            };
+            using SnapshotPtr = std::shared_ptr<Snapshot const>;
+
+        public:
+            /**
+             * @brief Calls a functor for each element of a path, empty elements are skipped
+             * @param a_strPath     Path to split at each '/'
+             * @param a_Functor     Receives the position and the size of the element, returns false to stop
+             */
+            template<typename F>
+            static void forEachPathElement(std::string const& a_strPath, F const& a_Functor) noexcept {
+                size_t ulBegin{ 0 };
+                while (ulBegin < a_strPath.size()) {
+                    size_t ulEnd{ a_strPath.find('/', ulBegin) };
+                    if (std::string::npos == ulEnd) {
+                        ulEnd = a_strPath.size();
+                    }
+                    if (ulEnd > ulBegin && !a_Functor(ulBegin, ulEnd - ulBegin)) {
+                        return;
+                    }
+                    ulBegin = ulEnd + 1;
+                }
+            }
+
+        public:
+            CommandRegistry() noexcept;
+            CommandRegistry(CommandRegistry const&) = delete;
+            CommandRegistry(CommandRegistry&&) = delete;
+            ~CommandRegistry() noexcept = default;
+            CommandRegistry& operator= (CommandRegistry const&) = delete;
+            CommandRegistry& operator= (CommandRegistry&&) = delete;
+
+            /**
+             * @brief Gives the current snapshot, without waiting for a change being applied
+             */
+            SnapshotPtr get() const noexcept;
+
+            /**
+             * @brief Adds commands, or replaces the commands with the same paths. The commands must have absolute paths.
+             *        The snapshot is published once for all, each folder being copied at most once.
+             */
+            void add(std::vector<UserCommand> const& a_vCommands) noexcept;
+            /**
+             * @brief Removes a command
+             * @return bool     False if there is no command with this path
+             */
+            bool del(std::string const& a_strPath) noexcept;
+            /**
+             * @brief Removes all the commands
+             */
+            void clear() noexcept;
+
+        private:
+            /**
+             * @brief Publishes a new snapshot, the previous one is kept alive by the readers still using it
+             */
+            void publish(NodePtr a_pRoot) noexcept;
+
+        private:
+            std::mutex m_WriteMutex{};      ///< Serializes the changes, never taken by the readers
+            SnapshotPtr m_pSnapshot;        ///< Only accessed with the atomic shared_ptr functions
+        };
+    } // console
+} // emb
@@ -50,6 +50,10 @@ namespace emb {
             (*this) << ResetTextFormat() << Commit();
         }
 
+        void IPrintableConsole::printFormat(char const* a_szFormat, FormatArg const* a_pArgs, size_t a_ulNbArgs) noexcept {
+            (*this) << Begin() << ClearLine(ClearLine::Type::All) << PrintFormat(a_szFormat, a_pArgs, a_ulNbArgs) << Commit();
+        }
+
         void IPrintableConsole::printTable(table::Table const& a_stTable) noexcept {
             (*this)
                 << Begin()
@@ -144,7 +148,7 @@ namespace emb {
         ConsoleSession& ConsoleSession::operator= (ConsoleSession&&) noexcept = default;
 
         IPrintableConsole& ConsoleSession::operator<< (PrintCommand const& a_Cmd) noexcept {
-            *m_pPrivateImpl << a_Cmd.copy();
+            *m_pPrivateImpl << a_Cmd;
             return *this;
         }
 
@@ -262,6 +266,13 @@ namespace emb {
             m_pPrivateImpl->addCommand(a_CommandInfo, a_funcCommandFunctor, a_funcAutoCompleteFunctor);
         }
 
+        void Console::addCommands(std::vector<UserCommand> const& a_vCommands) noexcept {
+            for (UserCommand const& command : a_vCommands) {
+                command.info.validate();
+            }
+            m_pPrivateImpl->addCommands(a_vCommands);
+        }
+
         void Console::delCommand(UserCommandInfo const& a_CommandInfo) noexcept {
             a_CommandInfo.validate();
             m_pPrivateImpl->delCommand(a_CommandInfo);
@@ -271,8 +282,8 @@ namespace emb {
             m_pPrivateImpl->delAllCommands();
         }
 
-        void Console::execCommand(UserCommandInfo const& a_CommandInfo, UserCommandData::Args const& a_CommandArgs) noexcept {
-            m_pPrivateImpl->execCommand(a_CommandInfo, a_CommandArgs);
+        std::future<UserCommandResult> Console::execCommand(UserCommandInfo const& a_CommandInfo, UserCommandData::Args const& a_CommandArgs) noexcept {
+            return m_pPrivateImpl->execCommand(a_CommandInfo, a_CommandArgs);
         }
 
         void Console::setStandardOutputCapture(StandardOutputFunctor const& a_funcCaptureFunctor) noexcept {
@@ -282,5 +293,21 @@ namespace emb {
         void Console::setPromptEnabled(bool a_bPromptEnabled) noexcept {
             m_pPrivateImpl->setPromptEnabled(a_bPromptEnabled);
         }
+
+        StandardOutputCaptureStats Console::getStandardOutputCaptureStats() const noexcept {
+            return m_pPrivateImpl->getStandardOutputCaptureStats();
+        }
+
+        bool Console::addInputStream(std::string const& a_strName, int a_iFd) noexcept {
+            return m_pPrivateImpl->addInputStream(a_strName, a_iFd);
+        }
+
+        void Console::delInputStream(std::string const& a_strName) noexcept {
+            m_pPrivateImpl->delInputStream(a_strName);
+        }
+
+        std::vector<OutputQueueStats> Console::getOutputQueueStats() const noexcept {
+            return m_pPrivateImpl->getOutputQueueStats();
+        }
     } // console
 } // emb
\ No newline at end of file
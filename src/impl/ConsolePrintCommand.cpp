@@ -1,6 +1,6 @@
 #include "EmbConsole.hpp"
 #include "ConsolePrivate.hpp"
-#include "base/Terminal.hpp"
+#include "PrintBatch.hpp"
 #include <iostream>
 #include <mutex>
 
@@ -28,202 +28,229 @@ namespace emb {
         ///// PrintCommands: Begin / Commit
         //////////////////////////////////////////////////
 
-        void Begin::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.begin();
+        void Begin::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.begin();
         }
-        void Commit::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.commit();
+        void Commit::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.commit();
         }
-        void InstantPrint::process(Terminal& a_rTerminal) const noexcept {
+        void Rollback::encode(PrintBatch&) const noexcept {
+        }
+        void InstantPrint::encode(PrintBatch&) const noexcept {
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Cursor Positioning
         //////////////////////////////////////////////////
 
-        void MoveCursorUp::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.moveCursorUp(m_uiN);
+        void MoveCursorUp::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.moveCursorUp(m_uiN);
         }
-        void MoveCursorDown::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.moveCursorDown(m_uiN);
+        void MoveCursorDown::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.moveCursorDown(m_uiN);
         }
-        void MoveCursorForward::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.moveCursorForward(m_uiN);
+        void MoveCursorForward::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.moveCursorForward(m_uiN);
         }
-        void MoveCursorBackward::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.moveCursorBackward(m_uiN);
+        void MoveCursorBackward::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.moveCursorBackward(m_uiN);
         }
-        void MoveCursorToNextLine::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.moveCursorToNextLine(m_uiN);
+        void MoveCursorToNextLine::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.moveCursorToNextLine(m_uiN);
         }
-        void MoveCursorToPreviousLine::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.moveCursorToPreviousLine(m_uiN);
+        void MoveCursorToPreviousLine::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.moveCursorToPreviousLine(m_uiN);
         }
-        void MoveCursorToRow::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.moveCursorToRow(m_uiR);
+        void MoveCursorToRow::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.moveCursorToRow(m_uiR);
         }
-        void MoveCursorToColumn::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.moveCursorToColumn(m_uiC);
+        void MoveCursorToColumn::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.moveCursorToColumn(m_uiC);
         }
-        void MoveCursorToPosition::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.moveCursorToPosition(m_uiR, m_uiC);
+        void MoveCursorToPosition::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.moveCursorToPosition(m_uiR, m_uiC);
         }
-        void SaveCursor::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.saveCursor();
+        void SaveCursor::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.saveCursor();
         }
-        void RestoreCursor::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.restoreCursor();
+        void RestoreCursor::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.restoreCursor();
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Cursor Visibility
         //////////////////////////////////////////////////
 
-        void SetCursorBlinking::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setCursorBlinking(m_bBlinking);
+        void SetCursorBlinking::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setCursorBlinking(m_bBlinking);
         }
-        void SetCursorVisible::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setCursorVisible(m_bVisible);
+        void SetCursorVisible::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setCursorVisible(m_bVisible);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Cursor Shape
         //////////////////////////////////////////////////
 
-        void SetCursorShape::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setCursorShape(m_eShape);
+        void SetCursorShape::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setCursorShape(m_eShape);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Viewport Positioning
         //////////////////////////////////////////////////
 
-        void ScrollUp::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.scrollUp(m_uiN);
+        void ScrollUp::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.scrollUp(m_uiN);
         }
-        void ScrollDown::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.scrollDown(m_uiN);
+        void ScrollDown::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.scrollDown(m_uiN);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Text Modification
         //////////////////////////////////////////////////
 
-        void InsertCharacter::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.insertCharacter(m_uiN);
+        void InsertCharacter::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.insertCharacter(m_uiN);
         }
-        void DeleteCharacter::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.deleteCharacter(m_uiN);
+        void DeleteCharacter::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.deleteCharacter(m_uiN);
         }
-        void EraseCharacter::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.eraseCharacter(m_uiN);
+        void EraseCharacter::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.eraseCharacter(m_uiN);
         }
-        void InsertLine::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.insertLine(m_uiN);
+        void InsertLine::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.insertLine(m_uiN);
         }
-        void DeleteLine::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.deleteLine(m_uiN);
+        void DeleteLine::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.deleteLine(m_uiN);
         }
-        void ClearDisplay::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.clearDisplay(m_eType);
+        void ClearDisplay::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.clearDisplay(m_eType);
         }
-        void ClearLine::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.clearLine(m_eType);
+        void ClearLine::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.clearLine(m_eType);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Text Formatting
         //////////////////////////////////////////////////
 
-        void ResetTextFormat::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.resetTextFormat();
+        void ResetTextFormat::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.resetTextFormat();
         }
-        void SetColor::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setColor(m_eFgColor, m_eBgColor);
+        void SetColor::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setColor(m_eFgColor, m_eBgColor);
         }
-        void SetNegativeColors::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setNegativeColors(m_bEnabled);
+        void SetNegativeColors::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setNegativeColors(m_bEnabled);
         }
-        void SetBold::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setBold(m_bEnabled);
+        void SetBold::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setBold(m_bEnabled);
         }
-        void SetItalic::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setItalic(m_bEnabled);
+        void SetItalic::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setItalic(m_bEnabled);
         }
-        void SetUnderline::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setUnderline(m_bEnabled);
+        void SetUnderline::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setUnderline(m_bEnabled);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Tabs
         //////////////////////////////////////////////////
 
-        void SetHorizontalTab::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setHorizontalTab();
+        void SetHorizontalTab::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setHorizontalTab();
         }
-        void HorizontalTabForward::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.goToHorizontalTabForward(m_uiN);
+        void HorizontalTabForward::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.goToHorizontalTabForward(m_uiN);
         }
-        void HorizontalTabBackward::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.goToHorizontalTabBackward(m_uiN);
+        void HorizontalTabBackward::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.goToHorizontalTabBackward(m_uiN);
         }
-        void ClearHorizontalTab::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.clearHorizontalTab(m_eType);
+        void ClearHorizontalTab::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.clearHorizontalTab(m_eType);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Designate Character Set
         //////////////////////////////////////////////////
 
-        void SetDecCharacterSet::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setDecCharacterSet(m_bEnabled);
+        void SetDecCharacterSet::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setDecCharacterSet(m_bEnabled);
         }
-        void PrintSymbol::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.printSymbol(m_eSymbol, m_uiN);
+        void PrintSymbol::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.printSymbol(m_eSymbol, m_uiN);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Scrolling Margins
         //////////////////////////////////////////////////
 
-        void SetScrollingRegion::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setScrollingRegion(m_uiT, m_uiB);
+        void SetScrollingRegion::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setScrollingRegion(m_uiT, m_uiB);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Window Title
         //////////////////////////////////////////////////
 
-        void SetWindowTitle::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.setWindowTitle(m_strTitle);
+        void SetWindowTitle::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.setWindowTitle(m_strTitle);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Alternate Screen Buffer
         //////////////////////////////////////////////////
 
-        void UseAlternateScreenBuffer::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.useAlternateScreenBuffer(m_bEnabled);
+        void UseAlternateScreenBuffer::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.useAlternateScreenBuffer(m_bEnabled);
         }
 
         //////////////////////////////////////////////////
         ///// PrintCommands: Miscellaneous
         //////////////////////////////////////////////////
 
-        void RingBell::process(Terminal& a_rTerminal) const noexcept {
-            a_rTerminal.ringBell();
-        }
-        void PrintNewLine::process(Terminal& a_rTerminal) const noexcept {
-            for (unsigned int i = 0; i < m_uiN; ++i) {
-                a_rTerminal.printNewLine();
+        void RingBell::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.ringBell();
+        }
+        void PrintNewLine::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.printNewLine(m_uiN);
+        }
+        PrintFormat::PrintFormat(PrintFormat const& a_Other)
+            : PrintCommand{ a_Other }
+            , m_strFormat{ a_Other.m_szFormat ? a_Other.m_szFormat : "" }
+            , m_vArgs(a_Other.m_pArgs, a_Other.m_pArgs + a_Other.m_ulNbArgs) {   // Not braces, which would take the pointers as arguments
+            // The texts of the arguments are copied first, their addresses do not change afterwards
+            for (FormatArg const& rArg : m_vArgs) {
+                if (FormatArg::Type::Text == rArg.eType) {
+                    m_strTexts.append(rArg.value.szText, rArg.ulSize);
+                }
+            }
+            size_t ulOffset{ 0 };
+            for (FormatArg& rArg : m_vArgs) {
+                if (FormatArg::Type::Text == rArg.eType) {
+                    rArg.value.szText = m_strTexts.data() + ulOffset;
+                    ulOffset += rArg.ulSize;
+                }
             }
+            m_szFormat = m_strFormat.c_str();
+            m_pArgs = m_vArgs.data();
+            m_ulNbArgs = m_vArgs.size();
+        }
+        PrintCommand::Ptr PrintFormat::copy() const noexcept {
+            return emb::tools::memory::make_unique<PrintFormat>(*this);
+        }
+        void PrintFormat::encode(PrintBatch& a_rBatch) const noexcept {
+            a_rBatch.printFormat(m_szFormat, m_pArgs, m_ulNbArgs);
         }
-        void PrintText::process(Terminal& a_rTerminal) const noexcept {
+        void PrintText::encode(PrintBatch& a_rBatch) const noexcept {
             if (0 == m_uiR || 0 == m_uiC) {
-                a_rTerminal.printText(m_strText);
+                a_rBatch.printText(m_strText);
             }
             else {
-                a_rTerminal.printTextAt(m_strText, m_uiR, m_uiC);
+                a_rBatch.printTextAt(m_strText, m_uiR, m_uiC);
             }
         }
     } // console
@@ -14,11 +14,17 @@
 #include "base/TerminalLocalTcp.hpp"
 #include "Tools.hpp"
 #include <algorithm>
+#include <cstdio>
 
 namespace emb {
     namespace console {
         using namespace std;
 
+        static size_t const s_ulMaxExecutedCommands{ 4 };           ///< Commands executed by the application running concurrently
+        static size_t const s_ulMaxPendingExecutedCommands{ 64 };   ///< Commands executed by the application waiting to run
+        static chrono::milliseconds const s_StopGracePeriod{ 200 };  ///< Time given to the cancelled commands to end when the console stops
+        static chrono::milliseconds const s_StopPollPeriod{ 2 };
+
         StdCapture ConsoleSessionWithTerminal::m_StdCapture{};
         StandardOutputFunctor ConsoleSessionWithTerminal::m_funcCaptureFunctor{};
         std::thread ConsoleSessionWithTerminal::m_CaptureThread{};
@@ -48,8 +54,116 @@ namespace emb {
             }
         }
 
+        namespace {
+            /**
+             * @brief Gives a short readable text for a duration, e.g. "250us", "12.5ms" or "3.20s"
+             */
+            string formatDuration(chrono::microseconds const a_Duration) noexcept {
+                char szValue[32];
+                long long const llUs{ static_cast<long long>(a_Duration.count()) };
+                if (llUs < 1000) {
+                    snprintf(szValue, sizeof(szValue), "%lldus", llUs);
+                }
+                else if (llUs < 1000000) {
+                    snprintf(szValue, sizeof(szValue), "%.3gms", static_cast<double>(llUs) / 1e3);
+                }
+                else {
+                    snprintf(szValue, sizeof(szValue), "%.3gs", static_cast<double>(llUs) / 1e6);
+                }
+                return szValue;
+            }
+
+            /// Print commands of a thread between Begin and Commit for a given session
+            struct StagedTransaction {
+                uint64_t ulSessionId{ 0 };
+                unsigned int uiDepth{ 0 };
+                bool bInstantPrint{ false };
+                PrintBatch batch{};
+            };
+            /// Transactions being built by a thread. Batches are recycled from a transaction to another to keep their memory.
+            struct StagingArea {
+                vector<StagedTransaction> vTransactions{};
+                vector<PrintBatch> vFreeBatches{};
+
+                StagedTransaction* find(uint64_t a_ulSessionId) noexcept {
+                    for (auto& transaction : vTransactions) {
+                        if (transaction.ulSessionId == a_ulSessionId) {
+                            return &transaction;
+                        }
+                    }
+                    return nullptr;
+                }
+                StagedTransaction& open(uint64_t a_ulSessionId) noexcept {
+                    vTransactions.push_back(StagedTransaction{ a_ulSessionId });
+                    if (!vFreeBatches.empty()) {
+                        vTransactions.back().batch.swap(vFreeBatches.back());
+                        vFreeBatches.pop_back();
+                    }
+                    return vTransactions.back();
+                }
+                void close(StagedTransaction& a_rTransaction) noexcept {
+                    a_rTransaction.batch.clear();
+                    vFreeBatches.push_back(std::move(a_rTransaction.batch));
+                    std::swap(a_rTransaction, vTransactions.back());
+                    vTransactions.pop_back();
+                }
+            };
+            thread_local StagingArea t_StagingArea{};
+            std::atomic<uint64_t> s_ulNextStagingId{ 1 };
+
+            /**
+             * @brief Adds a print command to the transaction the calling thread builds for a session (or a console).
+             *        Each thread builds its own transaction without any lock: an unbalanced Begin (e.g. because of an exception)
+             *        only affects the thread that sent it, until the thread abandons the transaction with Rollback.
+             * @param a_ulId            Identifier of the session (or console) the command is sent to
+             * @param a_Cmd             Command to add
+             * @param a_rCommittedBatch Receives the published transaction when the command is a Commit
+             * @param a_rbInstantPrint  Receives true if the published transaction requested an instant print
+             * @return true     If a transaction has been published
+             * @return false    Otherwise
+             */
+            bool stagePrintCommand(uint64_t a_ulId, PrintCommand const& a_Cmd, SharedPrintBatch& a_rCommittedBatch, bool& a_rbInstantPrint) noexcept {
+                StagedTransaction* pTransaction = t_StagingArea.find(a_ulId);
+                if (dynamic_cast<Rollback const*>(&a_Cmd)) {
+                    // The staged commands are discarded, whatever the depth of the transaction
+                    if (pTransaction) {
+                        t_StagingArea.close(*pTransaction);
+                    }
+                    return false;
+                }
+                if (dynamic_cast<Begin const*>(&a_Cmd))
+                {
+                    if (!pTransaction) {
+                        pTransaction = &t_StagingArea.open(a_ulId);
+                    }
+                    ++pTransaction->uiDepth;
+                }
+                if (!pTransaction) {
+                    // Commands sent outside of Begin ... Commit are not taken into consideration
+                    return false;
+                }
+                if (dynamic_cast<InstantPrint const*>(&a_Cmd)) {
+                    pTransaction->bInstantPrint = true;
+                }
+                else {
+                    a_Cmd.encode(pTransaction->batch);
+                }
+                if (!dynamic_cast<Commit const*>(&a_Cmd)) {
+                    return false;
+                }
+                // The whole transaction is published at once, the staged batch is swapped with an empty one
+                a_rCommittedBatch = SharedPrintBatch::create(pTransaction->batch);
+                a_rbInstantPrint = pTransaction->bInstantPrint;
+                if (0 == --pTransaction->uiDepth) {
+                    t_StagingArea.close(*pTransaction);
+                }
+                return true;
+            }
+        }
+
         ConsoleSession::Private::Private(TerminalPtr a_pTerminal) noexcept
-            : m_pTerminal{ a_pTerminal } {
+            : m_ulId{ s_ulNextStagingId++ }
+            , m_pTerminal{ a_pTerminal } {
         }
 
         //ConsoleSession::Private::Private(Private const& a_Obj) noexcept = default;
@@ -62,24 +176,11 @@ namespace emb {
 
         //ConsoleSession::Private& ConsoleSession::Private::operator= (Private&&) noexcept = default;
 
-        ConsoleSession::Private& ConsoleSession::Private::operator<< (PrintCommand::Ptr const& a_pCmd) noexcept {
-            if (dynamic_pointer_cast<Begin>(a_pCmd))
-            {
-                m_PrintMutex.lock();
-                m_bLocalInstantPrint = false;
-            }
-            lock_guard<mutex> l{ m_Mutex };
-            if (dynamic_pointer_cast<InstantPrint>(a_pCmd)) {
-                m_bLocalInstantPrint = true;
-            }
-            else {
-                m_PrintCommands.push_back(a_pCmd);
-            }
-            if (dynamic_pointer_cast<Commit>(a_pCmd))
-            {
-                m_pTerminal->setPrintCommands(m_PrintCommands, m_bInstantPrint | m_bLocalInstantPrint);
-                m_PrintMutex.unlock();
-                m_PrintCommands.clear();
+        ConsoleSession::Private& ConsoleSession::Private::operator<< (PrintCommand const& a_Cmd) noexcept {
+            SharedPrintBatch committedBatch{};
+            bool bInstantPrint{ false };
+            if (stagePrintCommand(m_ulId, a_Cmd, committedBatch, bInstantPrint)) {
+                m_pTerminal->setPrintCommands(committedBatch, m_bInstantPrint || bInstantPrint);
             }
             return *this;
         }
@@ -105,25 +206,82 @@ namespace emb {
         }
 
         string ConsoleSession::Private::getCurrentPath() const noexcept {
-            return m_pTerminal->getCurrentPath();
+            // A captured session has no terminal, and therefore no current folder
+            return m_pTerminal ? m_pTerminal->getCurrentPath() : "/";
+        }
+
+        ConsoleSessionCapture::ConsoleSessionCapture() noexcept
+            : ConsoleSession{ nullptr }
+            , m_ulId{ s_ulNextStagingId++ } {
+        }
+
+        IPrintableConsole& ConsoleSessionCapture::operator<< (PrintCommand const& a_Cmd) noexcept {
+            SharedPrintBatch committedBatch{};
+            bool bInstantPrint{ false };
+            if (stagePrintCommand(m_ulId, a_Cmd, committedBatch, bInstantPrint)) {
+                lock_guard<mutex> const lock{ m_Mutex };
+                committedBatch->appendText(m_strOutput);
+            }
+            return *this;
+        }
+
+        IPromptableConsole& ConsoleSessionCapture::operator<< (PromptCommand const& a_Cmd) noexcept {
+            PromptCommand::Ptr pOnCancel{};
+            {
+                lock_guard<mutex> const lock{ m_Mutex };
+                if (dynamic_cast<BeginPrompt const*>(&a_Cmd)) {
+                    m_pOnCancel = nullptr;
+                }
+                else if (dynamic_cast<OnCancel const*>(&a_Cmd)) {
+                    m_pOnCancel = a_Cmd.copy();
+                }
+                else if (dynamic_cast<CommitPrompt const*>(&a_Cmd)) {
+                    pOnCancel = std::move(m_pOnCancel);
+                }
+            }
+            if (pOnCancel) {
+                (*static_pointer_cast<OnCancel>(pOnCancel))();
+            }
+            return *this;
+        }
+
+        string ConsoleSessionCapture::output() const noexcept {
+            lock_guard<mutex> const lock{ m_Mutex };
+            return m_strOutput;
         }
 
         Console::Private::Private(Console& a_rConsole, Options const& a_Options) noexcept
-            : m_Options{ a_Options } {
+            : m_ulId{ s_ulNextStagingId++ }
+            , m_Options{ a_Options }
+            , m_EventLoop{ m_Options.get<OptionEventLoop>() ? *m_Options.get<OptionEventLoop>() : OptionEventLoop{} }
+            , m_pHistory{ make_shared<CommandHistory>(m_Options.get<OptionHistory>() ? *m_Options.get<OptionHistory>() : OptionHistory{}) }
+            , m_ExecPool{ s_ulMaxExecutedCommands, s_ulMaxPendingExecutedCommands } {
+            addBuiltInCommands();
             applyOptions(false);
             m_Thread = std::thread{ &Private::run, this };
             emb::tools::thread::set_thread_name(m_Thread, "Console");
         }
 
-        Console::Private::Private(Private const& a_Obj) noexcept {
+        Console::Private::Private(Private const& a_Obj) noexcept
+            : m_ulId{ s_ulNextStagingId++ }
+            , m_ExecPool{ s_ulMaxExecutedCommands, s_ulMaxPendingExecutedCommands } {
         }
 
-        Console::Private::Private(Private&& a_Obj) noexcept {
+        Console::Private::Private(Private&& a_Obj) noexcept
+            : m_ulId{ s_ulNextStagingId++ }
+            , m_ExecPool{ s_ulMaxExecutedCommands, s_ulMaxPendingExecutedCommands } {
         }
 
         Console::Private::~Private() noexcept {
             m_Stop = true;
+            m_EventLoop.wakeUp();
             m_Thread.join();
+            // The commands, cancelled by stop(), use the terminals and the event loop: they end before them
+            m_ExecPool.stop();
+            for (auto const& console : m_ConsolesVector) {
+                console->terminal()->stopCommands();
+                console->terminal()->setEventLoop(nullptr);
+            }
         }
 
         Console::Private& Console::Private::operator= (Private const&) noexcept {
@@ -135,8 +293,13 @@ namespace emb {
         }
 
         Console::Private& Console::Private::operator<< (PrintCommand const& a_Cmd) noexcept {
-            for (auto const& console : m_ConsolesVector) {
-                *console << a_Cmd;
+            // The transaction is staged and published once, then only referenced by every terminal
+            SharedPrintBatch committedBatch{};
+            bool bInstantPrint{ false };
+            if (stagePrintCommand(m_ulId, a_Cmd, committedBatch, bInstantPrint)) {
+                for (auto const& console : m_ConsolesVector) {
+                    console->terminal()->setPrintCommands(committedBatch, bInstantPrint);
+                }
             }
             return *this;
         }
@@ -189,63 +352,146 @@ namespace emb {
 
         void Console::Private::addCommand(UserCommandInfo const& a_CommandInfo, UserCommandFunctor0 const& a_funcCommandFunctor,
             UserCommandAutoCompleteFunctor const& a_funcAutoCompleteFunctor) noexcept {
-            m_vecCommonUserCommands.push_back(
-                UserCommand{
-                    a_CommandInfo,
-                    a_funcCommandFunctor,
-                    nullptr,
-                    a_funcAutoCompleteFunctor
-                }
-            );
-            for (auto const& console : m_ConsolesVector) {
-                console->terminal()->addCommand(a_CommandInfo, a_funcCommandFunctor, a_funcAutoCompleteFunctor);
-            }
+            m_pCommands->add({ UserCommand{ a_CommandInfo, a_funcCommandFunctor, a_funcAutoCompleteFunctor } });
         }
 
         void Console::Private::addCommand(UserCommandInfo const& a_CommandInfo, UserCommandFunctor1 const& a_funcCommandFunctor,
             UserCommandAutoCompleteFunctor const& a_funcAutoCompleteFunctor) noexcept {
-            m_vecCommonUserCommands.push_back(
-                UserCommand{
-                    a_CommandInfo,
-                    nullptr,
-                    a_funcCommandFunctor,
-                    a_funcAutoCompleteFunctor
-                }
-            );
-            for (auto const& console : m_ConsolesVector) {
-                console->terminal()->addCommand(a_CommandInfo, a_funcCommandFunctor, a_funcAutoCompleteFunctor);
-            }
+            m_pCommands->add({ UserCommand{ a_CommandInfo, a_funcCommandFunctor, a_funcAutoCompleteFunctor } });
+        }
+
+        void Console::Private::addBuiltInCommands() noexcept {
+            shared_ptr<CommandMetrics> const pMetrics{ m_pMetrics };
+            vector<UserCommand> vCommands{};
+            vCommands.emplace_back(UserCommandInfo("/console/stats", "Show the execution statistics of the commands",
+                "Usage: stats [prefix]\nShows, for each command whose path starts with the prefix, the number of calls, the failures "
+                "(refused or cancelled) and the distribution of the execution durations."),
+                [pMetrics](UserCommandData const& a_CmdData) {
+                    string const strPrefix{ a_CmdData.args.empty() ? "" : a_CmdData.args.front() };
+                    table::Table statsTable{};
+                    statsTable.strTitle = "Commands statistics";
+                    statsTable.vstrColumnsTitles = { "Command", "Calls", "Failures", "Mean", "Max" };
+                    for (auto const& bound : CommandMetrics::s_aBucketBounds) {
+                        statsTable.vstrColumnsTitles.push_back("<" + formatDuration(bound));
+                    }
+                    statsTable.vstrColumnsTitles.push_back(">=" + formatDuration(CommandMetrics::s_aBucketBounds.back()));
+                    for (auto const& elm : pMetrics->getStats()) {
+                        if (0 != elm.first.compare(0, strPrefix.size(), strPrefix)) {
+                            continue;
+                        }
+                        CommandMetrics::Stats const& stats = elm.second;
+                        uint64_t ulEnded{ 0 };
+                        for (uint64_t const ulCount : stats.aulBuckets) {
+                            ulEnded += ulCount;
+                        }
+                        table::Row row{
+                            table::Cell{ elm.first },
+                            table::Cell{ to_string(stats.ulCalls) },
+                            table::Cell{ to_string(stats.ulFailures), 0 == stats.ulFailures ? SetColor::Color::White : SetColor::Color::BrightRed },
+                            table::Cell{ 0 == ulEnded ? "-" : formatDuration(stats.totalDuration / static_cast<chrono::microseconds::rep>(ulEnded)) },
+                            table::Cell{ 0 == ulEnded ? "-" : formatDuration(stats.maxDuration) }
+                        };
+                        for (uint64_t const ulCount : stats.aulBuckets) {
+                            row.emplace_back(to_string(ulCount));
+                        }
+                        statsTable.vvstrRows.push_back(std::move(row));
+                    }
+                    if (statsTable.vvstrRows.empty()) {
+                        a_CmdData.console.print("No command called yet");
+                    }
+                    else {
+                        a_CmdData.console.printTable(statsTable);
+                    }
+                });
+            vCommands.emplace_back(UserCommandInfo("/console/stats/reset", "Reset the execution statistics of the commands"),
+                [pMetrics](UserCommandData const& a_CmdData) {
+                    pMetrics->reset();
+                    a_CmdData.console.print("Statistics reset");
+                });
+            m_pCommands->add(vCommands);
+        }
+
+        void Console::Private::addCommands(std::vector<UserCommand> const& a_vCommands) noexcept {
+            m_pCommands->add(a_vCommands);
         }
 
         void Console::Private::delCommand(UserCommandInfo const& a_CommandInfo) noexcept {
-            m_vecCommonUserCommands.erase(
-                std::remove_if(
-                    m_vecCommonUserCommands.begin(),
-                    m_vecCommonUserCommands.end(),
-                    [a_CommandInfo](UserCommand const& userCommand) { return userCommand.i.path == a_CommandInfo.path; }
-                ),
-                m_vecCommonUserCommands.end()
-            );
-            for (auto const& console : m_ConsolesVector) {
-                console->terminal()->delCommand(a_CommandInfo);
-            }
+            m_pCommands->del(a_CommandInfo.path);
         }
 
         void Console::Private::delAllCommands() noexcept {
+            m_pCommands->clear();
+            // The commands of the terminals themselves too
             for (auto const& console : m_ConsolesVector) {
                 console->terminal()->delAllCommands();
             }
         }
 
-        void Console::Private::execCommand(UserCommandInfo const& a_CommandInfo, UserCommandData::Args const& a_CommandArgs) noexcept {
-            for (auto const& console : m_ConsolesVector) {
-                console->terminal()->execCommand(a_CommandInfo, a_CommandArgs);
-                break;
+        future<UserCommandResult> Console::Private::execCommand(UserCommandInfo const& a_CommandInfo, UserCommandData::Args const& a_CommandArgs) noexcept {
+            auto pPromise = make_shared<promise<UserCommandResult>>();
+            future<UserCommandResult> result{ pPromise->get_future() };
+            UserCommandResult commandResult{};
+
+            // Only the commands of the application can be executed, the commands of a terminal work on its screen
+            CommandRegistry::CommandPtr pCommand{ m_pCommands->get()->find(Functions::getCanonicalPath(a_CommandInfo.path)) };
+            if (!pCommand) {
+                commandResult.status = UserCommandResult::Status::NotFound;
+                pPromise->set_value(std::move(commandResult));
+                return result;
             }
+
+            CancellationToken cancellation{ pCommand->info.timeout };
+            CommandMetrics::CountersPtr pCounters{ m_pMetrics->get(pCommand->info.path) };
+            bool const bPosted{ m_ExecPool.post([pCommand, a_CommandArgs, cancellation, pCounters, pPromise] {
+                ConsoleSessionCapture session{};
+                UserCommandData data{ pCommand->info, session, a_CommandArgs, cancellation };
+                auto const start = chrono::steady_clock::now();
+                Functions::runCommand(*pCommand, data);
+                pCounters->recordEnd(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start), cancellation.isCancelled() || data.hasFailed());
+
+                UserCommandResult commandResult{};
+                if (cancellation.isCancelled()) {
+                    commandResult.status = UserCommandResult::Status::Cancelled;
+                }
+                else if (data.hasFailed()) {
+                    commandResult.status = UserCommandResult::Status::Failed;
+                }
+                commandResult.output = session.output();
+                pPromise->set_value(std::move(commandResult));
+            }, cancellation) };
+            pCounters->recordCall(!bPosted);
+            if (!bPosted) {
+                commandResult.status = UserCommandResult::Status::TooManyCommands;
+                pPromise->set_value(std::move(commandResult));
+            }
+            return result;
         }
 
         void Console::Private::setStandardOutputCapture(StandardOutputFunctor const& a_funcCaptureFunctor) noexcept {
             ConsoleSessionWithTerminal::setStandardOutputCapture(a_funcCaptureFunctor);
+#ifdef unix
+            // Started right away when the console is already running, there is no periodic capture to start it
+            if (m_Thread.joinable()) {
+                ConsoleSessionWithTerminal::beginStdCapture();
+            }
+#endif
+        }
+
+        StandardOutputCaptureStats Console::Private::getStandardOutputCaptureStats() const noexcept {
+            return ConsoleSessionWithTerminal::getStdCaptureStats();
+        }
+
+        bool Console::Private::addInputStream(string const& a_strName, int a_iFd) noexcept {
+            bool const bRes{ m_InputStreams.add(a_strName, a_iFd) };
+            if (bRes) {
+                // The console thread must poll the new descriptor
+                m_EventLoop.wakeUp();
+            }
+            return bRes;
+        }
+
+        void Console::Private::delInputStream(string const& a_strName) noexcept {
+            m_InputStreams.remove(a_strName);
         }
 
         void Console::Private::setPromptEnabled(bool a_bPromptEnabled) noexcept {
@@ -263,27 +509,94 @@ namespace emb {
         }
 
         void Console::Private::processEvents() noexcept {
+            // The streams are printed by the console thread, which cannot wait for a full queue: what they write stays in
+            // the streams until the blocking queues have room
+            if (flushBlockingOutputQueues()) {
+                // Each group of lines read from a stream is printed in a single transaction
+                m_InputStreams.process([this](string const& a_strName, vector<string> const& a_vstrLines) {
+                    flushBlockingOutputQueues();
+                    (*this) << Begin() << ClearLine(ClearLine::Type::All);
+                    for (string const& strLine : a_vstrLines) {
+                        (*this) << PrintText("[" + a_strName + "] " + strLine) << PrintNewLine();
+                    }
+                    (*this) << Commit();
+                });
+            }
             for (auto const& console : m_ConsolesVector) {
                 console->terminal()->processEvents();
             }
         }
 
         void Console::Private::stop() noexcept {
+            // All the commands are cancelled, not only the foreground ones: a command waiting for its cancellation would never end
+            m_ExecPool.cancelAll();
+            for (auto const& console : m_ConsolesVector) {
+                console->terminal()->cancelCommands();
+            }
+            // What the cancelled commands print when they end (e.g. watch leaving the alternate screen) must reach the
+            // terminals before they stop
+            auto const deadline = chrono::steady_clock::now() + s_StopGracePeriod;
+            auto const isRunning = [](unique_ptr<ConsoleSessionWithTerminal> const& a_pConsole) { return a_pConsole->terminal()->hasRunningCommands(); };
+            while (any_of(m_ConsolesVector.begin(), m_ConsolesVector.end(), isRunning) && chrono::steady_clock::now() < deadline) {
+                processEvents();
+                this_thread::sleep_for(s_StopPollPeriod);
+            }
             for (auto const& console : m_ConsolesVector) {
                 console->terminal()->stop();
             }
             ConsoleSessionWithTerminal::endStdCapture();
         }
 
+        vector<OutputQueueStats> Console::Private::getOutputQueueStats() const noexcept {
+            vector<OutputQueueStats> vStats{};
+            for (auto const& console : m_ConsolesVector) {
+                vStats.push_back(console->terminal()->getOutputQueueStats());
+            }
+            return vStats;
+        }
+
         void Console::Private::run() {
+            m_EventLoop.attachCurrentThread();
             start();
             while (!m_Stop) {
                 processEvents();
-                this_thread::sleep_for(std::chrono::milliseconds(10));
+                waitForEvents();
             }
             stop();
         }
 
+        void Console::Private::waitForEvents() noexcept {
+            // Sleeps until a terminal receives an input, a print or a command is committed, or a terminal timer expires
+            m_viInputFds.clear();
+            EventLoop::Clock::time_point deadline{ EventLoop::Clock::time_point::max() };
+            for (auto const& console : m_ConsolesVector) {
+                auto const& pTerminal = console->terminal();
+                int const iFd{ pTerminal->getInputFd() };
+                if (iFd >= 0) {
+                    m_viInputFds.push_back(iFd);
+                }
+                deadline = min(deadline, pTerminal->getNextTimeout());
+            }
+            // A stream is not read while a blocking queue is full, its descriptor would stay readable
+            bool const bBlocking{ any_of(m_ConsolesVector.begin(), m_ConsolesVector.end(), [](unique_ptr<ConsoleSessionWithTerminal> const& a_pConsole) {
+                return a_pConsole->terminal()->isOutputQueueBlocking();
+            }) };
+            if (!bBlocking) {
+                m_InputStreams.appendFds(m_viInputFds);
+            }
+            if (!m_Stop) {
+                m_EventLoop.wait(m_viInputFds, deadline);
+            }
+        }
+
+        bool Console::Private::flushBlockingOutputQueues() noexcept {
+            bool bRoom{ true };
+            for (auto const& console : m_ConsolesVector) {
+                bRoom = console->terminal()->flushBlockingOutputQueue() && bRoom;
+            }
+            return bRoom;
+        }
+
         void Console::Private::applyOptions(bool a_bAutoStart) {
 #ifdef WIN32
             auto pOptStd = m_Options.get<OptionStd>();
@@ -295,22 +608,17 @@ namespace emb {
                     if (!pTerminalWindows && !pTerminalWindowsLegacy) {
                         if (TerminalWindows::isSupported()) {
                             m_ConsolesVector.push_back(emb::tools::memory::make_unique<TConsoleSessionWithTerminal<TerminalWindows>>());
+                            m_ConsolesVector.back()->terminal()->setSinkOptions("std", *pOptStd);
                         }
                         else {
                             m_ConsolesVector.push_back(emb::tools::memory::make_unique<TConsoleSessionWithTerminal<TerminalWindowsLegacy>>());
+                            m_ConsolesVector.back()->terminal()->setSinkOptions("std", *pOptStd);
                         }
                         if (a_bAutoStart) {
                             if (auto pAddedTerminal = m_ConsolesVector.back()->terminal()) {
+                                pAddedTerminal->setEventLoop(&m_EventLoop);
                                 pAddedTerminal->start();
                                 pAddedTerminal->setPromptEnabled(m_bPromptEnabled);
-                                for (auto const& userCommand : m_vecCommonUserCommands) {
-                                    if (userCommand.f0) {
-                                        pAddedTerminal->addCommand(userCommand.i, userCommand.f0, userCommand.fa);
-                                    }
-                                    else if (userCommand.f1) {
-                                        pAddedTerminal->addCommand(userCommand.i, userCommand.f1, userCommand.fa);
-                                    }
-                                }
                             }
                         }
                     }
@@ -326,6 +634,7 @@ namespace emb {
             if (pOptStd) {
                 if (pOptStd->bEnabled && !getTerminal<TerminalUnix>(m_ConsolesVector)) {
                     m_ConsolesVector.push_back(emb::tools::memory::make_unique<TConsoleSessionWithTerminal<TerminalUnix>>());
+                    m_ConsolesVector.back()->terminal()->setSinkOptions("std", *pOptStd);
                 }
                 else {
                     removeTerminalIfExists<TerminalUnix>(m_ConsolesVector);
@@ -336,6 +645,7 @@ namespace emb {
                 if (pOptUnixSocket->bEnabled && !getTerminal<TerminalUnixSocket>(m_ConsolesVector)) {
                     m_ConsolesVector.push_back(emb::tools::memory::make_unique<TConsoleSessionWithTerminal<TerminalUnixSocket>>(
                         pOptUnixSocket->strSocketFilePath, pOptUnixSocket->strShellFilePath));
+                    m_ConsolesVector.back()->terminal()->setSinkOptions("unixsocket", *pOptUnixSocket);
                 }
                 else {
                     removeTerminalIfExists<TerminalUnixSocket>(m_ConsolesVector);
@@ -346,6 +656,7 @@ namespace emb {
             if (pOptFile) {
                 if (pOptFile->bEnabled && !getTerminal<TerminalFile>(m_ConsolesVector)) {
                     m_ConsolesVector.push_back(emb::tools::memory::make_unique<TConsoleSessionWithTerminal<TerminalFile>>(pOptFile->strFilePath));
+                    m_ConsolesVector.back()->terminal()->setSinkOptions("file", *pOptFile);
                 }
                 else {
                     removeTerminalIfExists<TerminalFile>(m_ConsolesVector);
@@ -355,6 +666,7 @@ namespace emb {
             if (pOptSyslog) {
                 if (pOptSyslog->bEnabled && !getTerminal<TerminalSyslog>(m_ConsolesVector)) {
                     m_ConsolesVector.push_back(emb::tools::memory::make_unique<TConsoleSessionWithTerminal<TerminalSyslog>>(pOptSyslog));
+                    m_ConsolesVector.back()->terminal()->setSinkOptions("syslog", *pOptSyslog);
                 }
                 else {
                     removeTerminalIfExists<TerminalSyslog>(m_ConsolesVector);
@@ -364,11 +676,18 @@ namespace emb {
             if (pOptTcp) {
                 if (pOptTcp->bEnabled && !getTerminal<TerminalLocalTcp>(m_ConsolesVector)) {
                     m_ConsolesVector.push_back(emb::tools::memory::make_unique<TConsoleSessionWithTerminal<TerminalLocalTcp>>(pOptTcp));
+                    m_ConsolesVector.back()->terminal()->setSinkOptions("tcp", *pOptTcp);
                 }
                 else {
                     removeTerminalIfExists<TerminalLocalTcp>(m_ConsolesVector);
                 }
             }
+            for (auto const& console : m_ConsolesVector) {
+                console->terminal()->setEventLoop(&m_EventLoop);
+                console->terminal()->setCommonCommands(m_pCommands);
+                console->terminal()->setCommandMetrics(m_pMetrics);
+                console->terminal()->setHistory(m_pHistory);
+            }
         }
     } // console
 } // emb
\ No newline at end of file
@@ -2,7 +2,14 @@
 
 #include "EmbConsole.hpp"
 #include "Functions.hpp"
+#include "CommandRegistry.hpp"
+#include "CommandMetrics.hpp"
+#include "CommandHistory.hpp"
+#include "CommandPool.hpp"
+#include "PrintBatch.hpp"
 #include "StdCapture.hpp"
+#include "EventLoop.hpp"
+#include "InputStreams.hpp"
 #include "base/ITerminal.hpp"
 #include <mutex>
 #include <thread>
@@ -17,6 +24,14 @@ namespace emb {
                 return m_pTerminal;
             }
             static void setStandardOutputCapture(StandardOutputFunctor const& a_funcCaptureFunctor) {
+#ifdef unix
+                // The capture is persistent: a reader thread delivers the captured text as soon as it is written
+                if (!a_funcCaptureFunctor) {
+                    endStdCapture();
+                }
+                m_funcCaptureFunctor = a_funcCaptureFunctor;
+                m_StdCapture.setCaptureEvt(a_funcCaptureFunctor);
+#else
                 m_funcCaptureFunctor = a_funcCaptureFunctor;
                 m_bStopThread = true;
                 if (m_CaptureThread.joinable()) {
@@ -33,6 +48,7 @@ namespace emb {
                         }
                     } };
                 }
+#endif
             }
             static void beginStdCapture() {
                 if (m_funcCaptureFunctor) {
@@ -49,6 +65,20 @@ namespace emb {
                     m_StdCapture.EndCapture();
                 }
             }
+            /**
+             * @brief Gives the descriptor of the real standard output, not captured
+             */
+            static int getStdOutFd() {
+                return m_StdCapture.GetStdOutFd();
+            }
+            static StandardOutputCaptureStats getStdCaptureStats() {
+                StdCapture::Stats const stats = m_StdCapture.GetStats();
+                StandardOutputCaptureStats captureStats{};
+                captureStats.ulCapturedBytes = stats.capturedBytes;
+                captureStats.ulDroppedBytes = stats.droppedBytes;
+                captureStats.ulPipeFull = stats.pipeFull;
+                return captureStats;
+            }
             static void setCaptureEndEvt(std::function<void(void)> const& a_fctCaptureEnd) {
                 m_StdCapture.setCaptureEndEvt(a_fctCaptureEnd);
             }
@@ -87,6 +117,29 @@ namespace emb {
             }
         };
 
+        /**
+         * @brief Session of a command executed by the application: what the command prints is kept in memory, without any
+         *        terminal nor rendering, and its prompts are cancelled since nobody can answer them.
+         */
+        class ConsoleSessionCapture : public ConsoleSession {
+        public:
+            ConsoleSessionCapture() noexcept;
+
+            IPrintableConsole& operator<< (PrintCommand const&) noexcept override;
+            IPromptableConsole& operator<< (PromptCommand const&) noexcept override;
+
+            /**
+             * @brief Gives the text printed so far, without colors nor cursor moves
+             */
+            std::string output() const noexcept;
+
+        private:
+            uint64_t const m_ulId;                  ///< Identifies the session in the per-thread staging areas
+            mutable std::mutex m_Mutex{};
+            std::string m_strOutput{};
+            PromptCommand::Ptr m_pOnCancel{};       ///< Called when the prompt being built is committed
+        };
+
         class ConsoleSession::Private {
         public:
             Private(TerminalPtr) noexcept;
@@ -95,23 +148,19 @@ namespace emb {
             virtual ~Private() noexcept;
             Private& operator= (Private const&) noexcept = delete;
             Private& operator= (Private&&) noexcept = delete;
-            Private& operator<< (PrintCommand::Ptr const&) noexcept;
+            Private& operator<< (PrintCommand const&) noexcept;
             Private& operator<< (PromptCommand::Ptr const&) noexcept;
             void setInstantPrint(bool a_bInstantPrint) noexcept;
             std::string getCurrentPath() const noexcept;
         private:
+            uint64_t const m_ulId;      ///< Identifies the session in the per-thread staging areas
             TerminalPtr m_pTerminal{};
 
-            std::mutex m_Mutex{};
-            std::recursive_mutex m_PrintMutex{};
-            PrintCommand::VPtr m_PrintCommands{};
-
             std::mutex m_Mutex2{};
             std::recursive_mutex m_PromptMutex{};
             PromptCommand::VPtr m_PromptCommands{};
 
-            bool m_bInstantPrint{ false };
-            bool m_bLocalInstantPrint{ false };
+            std::atomic<bool> m_bInstantPrint{ false };
         };
 
         class Console::Private : protected ITerminal {
@@ -131,34 +180,49 @@ namespace emb {
             void setMachineName(std::string const&) noexcept;
             void addCommand(UserCommandInfo const&, UserCommandFunctor0 const&, UserCommandAutoCompleteFunctor const&) noexcept;
             void addCommand(UserCommandInfo const&, UserCommandFunctor1 const&, UserCommandAutoCompleteFunctor const&) noexcept;
+            void addCommands(std::vector<UserCommand> const&) noexcept;
             void delCommand(UserCommandInfo const&) noexcept;
             void delAllCommands() noexcept;
-            void execCommand(UserCommandInfo const&, UserCommandData::Args const&) noexcept;
+            std::future<UserCommandResult> execCommand(UserCommandInfo const&, UserCommandData::Args const&) noexcept;
             void setStandardOutputCapture(StandardOutputFunctor const&) noexcept;
+            StandardOutputCaptureStats getStandardOutputCaptureStats() const noexcept;
+            bool addInputStream(std::string const&, int) noexcept;
+            void delInputStream(std::string const&) noexcept;
             void setPromptEnabled(bool) noexcept;
+            std::vector<OutputQueueStats> getOutputQueueStats() const noexcept;
 
         private:
             void start() noexcept override;
             void processEvents() noexcept override;
             void stop() noexcept override;
             void run();
+            void waitForEvents() noexcept;
+            /**
+             * @brief Processes the blocking output queues of the terminals (see Terminal::isOutputQueueBlocking()), so that
+             *        the console thread can print without losing anything
+             * @return bool     True if all the queues have room
+             */
+            bool flushBlockingOutputQueues() noexcept;
             void applyOptions(bool a_bAutoStart);
+            /**
+             * @brief Adds the commands of the console itself, under /console
+             */
+            void addBuiltInCommands() noexcept;
 
         private:
-            struct UserCommand {
-                UserCommandInfo i;
-                UserCommandFunctor0 f0;
-                UserCommandFunctor1 f1;
-                UserCommandAutoCompleteFunctor fa;
-            };
-
-        private:
+            uint64_t const m_ulId;      ///< Identifies the console in the per-thread staging areas
+            Options m_Options{};
+            EventLoop m_EventLoop;      ///< Must outlive the terminals, which wake it up
             std::thread m_Thread{};
             volatile std::atomic_bool m_Stop{ false };
             std::vector<std::unique_ptr<ConsoleSessionWithTerminal>> m_ConsolesVector{};
-            Options m_Options{};
+            std::vector<int> m_viInputFds{};
+            InputStreams m_InputStreams{};
             bool m_bPromptEnabled{ false };
-            std::vector<UserCommand> m_vecCommonUserCommands{};
+            std::shared_ptr<CommandRegistry> m_pCommands{ std::make_shared<CommandRegistry>() };   ///< Commands of the application, shared by all the terminals
+            std::shared_ptr<CommandMetrics> m_pMetrics{ std::make_shared<CommandMetrics>() };     ///< Execution counters of all the commands
+            std::shared_ptr<CommandHistory> m_pHistory{ std::make_shared<CommandHistory>(OptionHistory{}) };  ///< Entries typed in all the terminals
+            CommandPool m_ExecPool;     ///< Runs the commands executed by the application, destroyed first to end them
         };
     } // console
 } // emb
\ No newline at end of file
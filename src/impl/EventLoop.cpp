@@ -0,0 +1,144 @@
+#include "EventLoop.hpp"
+#include <thread>
+#include <algorithm>
+#include <limits>
+#ifdef unix
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#endif
+
+namespace emb {
+    namespace console {
+        using namespace std;
+
+        EventLoop::EventLoop(OptionEventLoop const& a_Option) noexcept
+            : m_eStrategy{ a_Option.eStrategy }
+            , m_SpinDuration{ a_Option.uiSpinDurationUs } {
+#ifdef unix
+#ifdef __linux__
+            m_iWakeUpReadFd = m_iWakeUpWriteFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+            int aiFds[2]{ -1, -1 };
+            if (0 == pipe(aiFds)) {
+                for (int const iFd : aiFds) {
+                    fcntl(iFd, F_SETFL, fcntl(iFd, F_GETFL) | O_NONBLOCK);
+                    fcntl(iFd, F_SETFD, FD_CLOEXEC);
+                }
+                m_iWakeUpReadFd = aiFds[0];
+                m_iWakeUpWriteFd = aiFds[1];
+            }
+#endif
+#endif
+        }
+
+        EventLoop::~EventLoop() noexcept {
+#ifdef unix
+            if (m_iWakeUpWriteFd >= 0 && m_iWakeUpWriteFd != m_iWakeUpReadFd) {
+                close(m_iWakeUpWriteFd);
+            }
+            if (m_iWakeUpReadFd >= 0) {
+                close(m_iWakeUpReadFd);
+            }
+#endif
+        }
+
+        void EventLoop::wakeUp() noexcept {
+            // Only the first producer since the last wait signals, and only if the console thread sleeps
+            if (!m_bPending.exchange(true) && m_bWaiting.load()) {
+#ifdef unix
+#ifdef __linux__
+                uint64_t const ulValue{ 1 };
+#else
+                char const ulValue{ 1 };
+#endif
+                ssize_t const lWritten{ write(m_iWakeUpWriteFd, &ulValue, sizeof(ulValue)) };
+                (void)lWritten;
+#else
+                // Taking the lock ensures the console thread is either before its predicate check or really waiting
+                { lock_guard<mutex> lock{ m_Mutex }; }
+                m_ConditionVariable.notify_one();
+#endif
+            }
+        }
+
+        void EventLoop::wait(vector<int> const& a_viFds, Clock::time_point const a_Deadline) noexcept {
+            switch (m_eStrategy) {
+            case OptionEventLoop::Strategy::BusyPoll:
+                m_bPending.store(false);
+                return;
+            case OptionEventLoop::Strategy::AdaptiveSpin: {
+                Clock::time_point const spinEnd{ min(Clock::now() + m_SpinDuration, a_Deadline) };
+                while (Clock::now() < spinEnd) {
+                    if (m_bPending.exchange(false) || isReadable(a_viFds)) {
+                        return;
+                    }
+                    this_thread::yield();
+                }
+                if (Clock::now() >= a_Deadline) {
+                    return;
+                }
+                block(a_viFds, a_Deadline);
+                return;
+            }
+            case OptionEventLoop::Strategy::Block:
+            default:
+                block(a_viFds, a_Deadline);
+                return;
+            }
+        }
+
+        void EventLoop::block(vector<int> const& a_viFds, Clock::time_point const a_Deadline) noexcept {
+            // The waiting flag must be visible before the pending flag is checked, so that a producer signaling in between
+            // sees it and writes to the wake up descriptor
+            m_bWaiting.store(true);
+            if (m_bPending.exchange(false)) {
+                m_bWaiting.store(false);
+                return;
+            }
+#ifdef unix
+            int iTimeoutMs{ -1 };
+            if (a_Deadline != Clock::time_point::max()) {
+                auto const remaining = chrono::duration_cast<chrono::milliseconds>(a_Deadline - Clock::now() + chrono::microseconds{ 999 });
+                iTimeoutMs = static_cast<int>(max<long long>(0, min<long long>(remaining.count(), numeric_limits<int>::max())));
+            }
+            m_vPollFds.clear();
+            m_vPollFds.push_back({ m_iWakeUpReadFd, POLLIN, 0 });
+            for (int const iFd : a_viFds) {
+                m_vPollFds.push_back({ iFd, POLLIN, 0 });
+            }
+            if (poll(m_vPollFds.data(), m_vPollFds.size(), iTimeoutMs) > 0 && (m_vPollFds.front().revents & POLLIN)) {
+                uint64_t ulValue{ 0 };
+                while (read(m_iWakeUpReadFd, &ulValue, sizeof(ulValue)) > 0) {
+                }
+            }
+#else
+            // Windows console input is not waitable along with the other events: the wait is capped so that keys are still
+            // polled regularly by the terminals
+            Clock::time_point const deadline{ min(a_Deadline, Clock::now() + chrono::milliseconds{ 10 }) };
+            unique_lock<mutex> lock{ m_Mutex };
+            m_ConditionVariable.wait_until(lock, deadline, [this]() { return m_bPending.load(); });
+#endif
+            m_bWaiting.store(false);
+            // Anything signaled from now on is processed by the next loop iteration
+            m_bPending.store(false);
+        }
+
+        bool EventLoop::isReadable(vector<int> const& a_viFds) noexcept {
+#ifdef unix
+            if (a_viFds.empty()) {
+                return false;
+            }
+            m_vPollFds.clear();
+            for (int const iFd : a_viFds) {
+                m_vPollFds.push_back({ iFd, POLLIN, 0 });
+            }
+            return poll(m_vPollFds.data(), m_vPollFds.size(), 0) > 0;
+#else
+            return false;
+#endif
+        }
+    } // console
+} // emb
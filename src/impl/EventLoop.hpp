@@ -0,0 +1,73 @@
+#pragma once
+
+#include "EmbConsole.hpp"
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#ifdef unix
+#include <poll.h>
+#endif
+
+namespace emb {
+    namespace console {
+        /**
+         * @brief Puts the console thread to sleep until something has to be processed: a producer committed print commands or
+         *        user entries, an input file descriptor became readable, or a terminal timer expired.
+         */
+        class EventLoop {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+        public:
+            EventLoop(OptionEventLoop const& a_Option = OptionEventLoop{}) noexcept;
+            EventLoop(EventLoop const&) = delete;
+            EventLoop(EventLoop&&) = delete;
+            ~EventLoop() noexcept;
+            EventLoop& operator= (EventLoop const&) = delete;
+            EventLoop& operator= (EventLoop&&) = delete;
+
+            /**
+             * @brief Records the calling thread as the one running the loop
+             */
+            void attachCurrentThread() noexcept { m_ThreadId = std::this_thread::get_id(); }
+            /**
+             * @brief Tells if the calling thread is the one running the loop, which must never wait for the loop itself
+             */
+            bool isCurrentThread() const noexcept { return std::this_thread::get_id() == m_ThreadId.load(); }
+
+            /**
+             * @brief Wakes the console thread up. Cheap when the console thread is not sleeping: no system call is made.
+             */
+            void wakeUp() noexcept;
+
+            /**
+             * @brief Waits for an event, according to the strategy
+             * @param a_viFds       File descriptors that must wake the console thread up when readable
+             * @param a_Deadline    Time at which the console thread must wake up anyway
+             */
+            void wait(std::vector<int> const& a_viFds, Clock::time_point const a_Deadline) noexcept;
+
+        private:
+            void block(std::vector<int> const& a_viFds, Clock::time_point const a_Deadline) noexcept;
+            bool isReadable(std::vector<int> const& a_viFds) noexcept;
+
+        private:
+            OptionEventLoop::Strategy const m_eStrategy;
+            std::chrono::microseconds const m_SpinDuration;
+            std::atomic<std::thread::id> m_ThreadId{};
+            std::atomic<bool> m_bPending{ false };  ///< Something has been signaled since the last wait
+            std::atomic<bool> m_bWaiting{ false };  ///< The console thread is (about to be) blocked
+#ifdef unix
+            int m_iWakeUpReadFd{ -1 };
+            int m_iWakeUpWriteFd{ -1 };
+            std::vector<struct pollfd> m_vPollFds{};
+#else
+            std::mutex m_Mutex{};
+            std::condition_variable m_ConditionVariable{};
+#endif
+        };
+    } // console
+} // emb
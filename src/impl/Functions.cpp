@@ -1,13 +1,40 @@
 #include "Functions.hpp"
 #include "ConsolePrivate.hpp"
-#include <sstream>
+#include "base/Terminal.hpp"
 #include <algorithm>
 #include <vector>
+#include <cstdlib>
 
 namespace emb {
     namespace console {
         using namespace std;
 
+        static size_t const s_ulMaxRunningCommands{ 8 };    ///< Commands running concurrently
+        static size_t const s_ulMaxPendingCommands{ 64 };   ///< Commands waiting for one of the running commands to end
+        static size_t const s_ulMaxRunningAutoCompletions{ 2 };     ///< Completers running concurrently, a stuck one does not block the next
+        static size_t const s_ulMaxPendingAutoCompletions{ 2 };
+        static size_t const s_ulMaxCachedAutoCompletions{ 32 };
+        static chrono::milliseconds const s_AutoCompletionTimeout{ 2000 };      ///< Completers are cancelled after this delay
+        static chrono::milliseconds const s_AutoCompletionCacheDuration{ 5000 }; ///< Completers results may change, they are not kept long
+        static chrono::milliseconds const s_DefaultWatchInterval{ 2000 };
+        static chrono::milliseconds const s_MinWatchInterval{ 100 };
+        static unsigned int const s_uiWatchFirstRow{ 3 };   ///< The header and an empty line are above the output of a watched command
+
+        namespace {
+            /**
+             * @brief Gives the range of a sorted map whose keys start with a prefix
+             */
+            template<typename M>
+            pair<typename M::const_iterator, typename M::const_iterator> prefixRange(M const& a_Map, string const& a_strPrefix) noexcept {
+                auto itBegin = a_Map.lower_bound(a_strPrefix);
+                auto itEnd = itBegin;
+                while (a_Map.end() != itEnd && 0 == itEnd->first.compare(0, a_strPrefix.size(), a_strPrefix)) {
+                    ++itEnd;
+                }
+                return { itBegin, itEnd };
+            }
+        }
+
         bool Functions::isAbsolutePath(std::string const& a_Path) noexcept {
             // Absolute path if not empty and starts with a '/'
             return a_Path.size() > 0 && '/' == a_Path.at(0);
@@ -53,29 +80,30 @@ namespace emb {
         }
 
         string Functions::getCanonicalPath(std::string const& a_strPath, bool a_bEndWithDelimiter) noexcept {
-            // List of each element inside the path (each element is either a directory or a command)
-            vector<string> vstrResult{};
+            // List of each element inside the path (each element is either a directory or a command), as position and size
+            vector<pair<size_t, size_t>> vElements{};
 
             // We split the input path at each "/" and run some code on each token
-            string strToken{};
-            istringstream streamInput{ a_strPath };
-            while (getline(streamInput, strToken, '/')) {
-                if (".." == strToken) {
+            CommandRegistry::forEachPathElement(a_strPath, [&](size_t const a_ulPos, size_t const a_ulSize) {
+                if (2 == a_ulSize && 0 == a_strPath.compare(a_ulPos, a_ulSize, "..")) {
                     // If the token is .. we need to remove the last token if it exists
-                    if (vstrResult.size() > 0) {
-                        vstrResult.pop_back();
+                    if (vElements.size() > 0) {
+                        vElements.pop_back();
                     }
                 }
-                else if (!strToken.empty() && "." != strToken) {
-                    // if the token is empty or ., we do nothing, otherwise, we add the token to the list of elements
-                    vstrResult.push_back(strToken);
+                else if (1 != a_ulSize || '.' != a_strPath[a_ulPos]) {
+                    // if the token is ., we do nothing, otherwise, we add the token to the list of elements
+                    vElements.emplace_back(a_ulPos, a_ulSize);
                 }
-            }
+                return true;
+            });
 
             // We then join the remaining elements of the list into a single string, elements are separated by a '/'
             string strResult{};
-            for (auto const& elm : vstrResult) {
-                strResult += "/" + elm;
+            strResult.reserve(a_strPath.size() + 2);
+            for (auto const& elm : vElements) {
+                strResult += '/';
+                strResult.append(a_strPath, elm.first, elm.second);
             }
             if (strResult.empty()) {
                 // If it is the root, we keep only a /
@@ -83,30 +111,63 @@ namespace emb {
             }
 
             // If it is requested to end with a separator, we add it if needed
-            if(a_bEndWithDelimiter && strResult.find_last_of('/') != strResult.size() - 1) {
+            if(a_bEndWithDelimiter && '/' != strResult.back()) {
                 strResult += "/";
             }
 
             return strResult;
         }
 
-        Functions::Functions(ConsoleSessionWithTerminal& a_rConsole) noexcept : m_rConsole{ a_rConsole } {
-            addCommand(UserCommandInfo("/ls", "List information about the commands"), [&](UserCommandData const& a_CmdData) {
+        void Functions::runCommand(UserCommand const& a_Command, UserCommandData const& a_Data) noexcept {
+            try {
+                if (a_Command.function0) {
+                    a_Command.function0();
+                }
+                else if (a_Command.function1) {
+                    a_Command.function1(a_Data);
+                }
+            }
+            catch (exception const& e) {
+                // A transaction left open by the exception would capture the next prints of the thread
+                a_Data.console << Rollback();
+                a_Data.console.printError("Command '" + a_Command.info.path + "' failed: " + e.what());
+                a_Data.fail();
+            }
+            catch (...) {
+                a_Data.console << Rollback();
+                a_Data.console.printError("Command '" + a_Command.info.path + "' failed with an unknown exception");
+                a_Data.fail();
+            }
+        }
+
+        Functions::Functions(ConsoleSessionWithTerminal& a_rConsole) noexcept
+            : m_rConsole{ a_rConsole }
+            , m_pCommonCommands{ make_shared<CommandRegistry>() }
+            , m_pMetrics{ make_shared<CommandMetrics>() }
+            , m_AutoCompletionPool{ s_ulMaxRunningAutoCompletions, s_ulMaxPendingAutoCompletions }
+            , m_CommandPool{ s_ulMaxRunningCommands, s_ulMaxPendingCommands } {
+            vector<UserCommand> vCommands{};
+            vCommands.emplace_back(UserCommandInfo("/ls", "List information about the commands"), [&](UserCommandData const& a_CmdData) {
                 string output{};
                 bool bAll = a_CmdData.args.size() > 0 && a_CmdData.args.at(0).find('a') != string::npos;
                 bool bLongListing = a_CmdData.args.size() > 0 && a_CmdData.args.at(0).find('l') != string::npos;
 
                 if (bAll) {
+                    Snapshots const snapshots{ getSnapshots() };
+                    // The commands of the terminal are hidden by the commands of the application with the same paths
+                    CommandRegistry::MCommands mapCommands{ snapshots.pCommon->commands() };
+                    CommandRegistry::MCommands const mapLocalCommands{ snapshots.pLocal->commands() };
+                    mapCommands.insert(mapLocalCommands.begin(), mapLocalCommands.end());
                     output += "===== Global commands =====\n";
-                    for (auto const& elm : m_mapFunctions) {
+                    for (auto const& elm : mapCommands) {
                         if (isRootCommand(elm.first)) {
-                            output += elm.first + "\t" + (bLongListing ? elm.second.i.description + "\n" : "");
+                            output += elm.first + "\t" + (bLongListing ? elm.second->info.description + "\n" : "");
                         }
                     }
                     output += std::string(bLongListing ? "" : "\n") + "===== Local commands =====\n";
-                    for (auto const& elm : m_mapFunctions) {
+                    for (auto const& elm : mapCommands) {
                         if (!isRootCommand(elm.first)) {
-                            output += elm.first + "\t" + (bLongListing ? elm.second.i.description + "\n" : "");
+                            output += elm.first + "\t" + (bLongListing ? elm.second->info.description + "\n" : "");
                         }
                     }
                 }
@@ -134,11 +195,11 @@ namespace emb {
                 a_CmdData.console.print(output);
             });
 
-            addCommand(UserCommandInfo("/pwd", "Print the name of the current working directory"), [&](UserCommandData const& a_CmdData) {
+            vCommands.emplace_back(UserCommandInfo("/pwd", "Print the name of the current working directory"), [&](UserCommandData const& a_CmdData) {
                 a_CmdData.console.print(a_CmdData.console.getCurrentPath());
             });
 
-            addCommand(UserCommandInfo("/help", "Display information about commands"), [&](UserCommandData const& a_CmdData) {
+            vCommands.emplace_back(UserCommandInfo("/help", "Display information about commands"), [&](UserCommandData const& a_CmdData) {
                 if (a_CmdData.args.size() <= 0) {
                     a_CmdData.console.printError("Usage: help <cmd>");
                 }
@@ -147,13 +208,13 @@ namespace emb {
                     if (a_CmdData.args.at(0).at(0) != '/') {
                         cmd = getCanonicalPath(a_CmdData.console.getCurrentPath() + "/" + cmd);
                     }
-                    auto const& it = m_mapFunctions.find(cmd);
-                    if (it != m_mapFunctions.end()) {
-                        if (it->second.i.help.empty()) {
+                    CommandRegistry::CommandPtr const pCommand{ getSnapshots().find(cmd) };
+                    if (pCommand) {
+                        if (pCommand->info.help.empty()) {
                             a_CmdData.console.printError("No help available for '" + cmd + "' command");
                         }
                         else {
-                            a_CmdData.console.print(it->second.i.help);
+                            a_CmdData.console.print(pCommand->info.help);
                         }
                     }
                     else {
@@ -161,59 +222,97 @@ namespace emb {
                     }
                 }
             });
+            vCommands.emplace_back(UserCommandInfo("/watch", "Execute a command periodically, showing its output full screen",
+                "Usage: watch [-n <ms>] <cmd> [args...]\n"
+                "Executes <cmd> every <ms> milliseconds (2000 by default) until Ctrl-C is pressed. Only the lines of the output\n"
+                "that changed are printed again."), [&](UserCommandData const& a_CmdData) {
+                watch(a_CmdData);
+            });
+            m_LocalCommands.add(vCommands);
         }
 
         //Functions::Functions(Functions const&) = default;
         //Functions::Functions(Functions&&) noexcept = default;
-        Functions::~Functions() noexcept = default;
+        Functions::~Functions() noexcept {
+            {
+                // The completers still running must neither notify the owner nor keep the pool waiting
+                lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+                m_fctAutoCompletionReady = nullptr;
+            }
+            // The pools wait for the commands: all of them must end, not only the foreground one
+            cancelCommands();
+        }
         //Functions& Functions::operator= (Functions const&) = default;
         //Functions& Functions::operator= (Functions&&) noexcept = default;
 
+        void Functions::setCommonCommands(shared_ptr<CommandRegistry> const& a_pCommands) noexcept {
+            atomic_store(&m_pCommonCommands, a_pCommands);
+        }
+
+        void Functions::setCommandMetrics(shared_ptr<CommandMetrics> const& a_pMetrics) noexcept {
+            atomic_store(&m_pMetrics, a_pMetrics);
+        }
+
         void Functions::addCommand(UserCommandInfo const& a_CommandInfo, UserCommandFunctor0 const& a_funcCommandFunctor,
                                    UserCommandAutoCompleteFunctor const& a_funcAutoCompleteFunctor) noexcept {
-            Functor f;
-            f.i = a_CommandInfo;
-            f.f0 = a_funcCommandFunctor;
-            f.fa = a_funcAutoCompleteFunctor;
-            m_mapFunctions[a_CommandInfo.path] = f;
+            m_LocalCommands.add({ UserCommand{ a_CommandInfo, a_funcCommandFunctor, a_funcAutoCompleteFunctor } });
         }
 
         void Functions::addCommand(UserCommandInfo const& a_CommandInfo, UserCommandFunctor1 const& a_funcCommandFunctor,
                                    UserCommandAutoCompleteFunctor const& a_funcAutoCompleteFunctor) noexcept {
-            Functor f;
-            f.i = a_CommandInfo;
-            f.f1 = a_funcCommandFunctor;
-            f.fa = a_funcAutoCompleteFunctor;
-            m_mapFunctions[a_CommandInfo.path] = f;
+            m_LocalCommands.add({ UserCommand{ a_CommandInfo, a_funcCommandFunctor, a_funcAutoCompleteFunctor } });
         }
 
         void Functions::delCommand(UserCommandInfo const& a_CommandInfo) noexcept {
-            m_mapFunctions.erase(a_CommandInfo.path);
+            m_LocalCommands.del(a_CommandInfo.path);
         }
 
         void Functions::delAllCommands() noexcept {
-            m_mapFunctions.clear();
+            m_LocalCommands.clear();
+        }
+
+        Functions::Snapshots Functions::getSnapshots() const noexcept {
+            Snapshots snapshots{};
+            snapshots.pCommon = atomic_load(&m_pCommonCommands)->get();
+            snapshots.pLocal = m_LocalCommands.get();
+            return snapshots;
         }
 
-        Functions::Error Functions::processEntry(UserEntry const& a_UserEntry) noexcept {
-            Functor f;
+        CommandRegistry::CommandPtr Functions::Snapshots::find(string const& a_strCanonicalPath) const noexcept {
+            CommandRegistry::CommandPtr pCommand{ pCommon->find(a_strCanonicalPath) };
+            return pCommand ? pCommand : pLocal->find(a_strCanonicalPath);
+        }
+
+        Functions::Error Functions::processEntry(UserEntry a_UserEntry) noexcept {
+            CommandRegistry::CommandPtr pCommand{};
             string strCommand{};
             vector<string> vstrArguments{};
-            Error result{ searchCommand(f, strCommand, vstrArguments, a_UserEntry.strUserEntry, a_UserEntry.strCurrentPath) };
+            Error result{ searchCommand(pCommand, strCommand, vstrArguments, a_UserEntry.strUserEntry, a_UserEntry.strCurrentPath) };
 
             if (Error::NoError == result) {
-                if (f.f0) {
-                    m_future = std::async(std::launch::async, [=] {
-                        f.f0();
-                    });
-                }
-                else if (f.f1) {
-                    m_future = std::async(std::launch::async, [fct = f.f1, info = f.i, terminal = m_rConsole.get().terminal(), vstrArguments]{
-                        ConsoleSession session{ terminal };
-                        session.setInstantPrint(true);
-                        UserCommandData data{ info, session, vstrArguments };
-                        fct(data);
-                    });
+                bool bPosted{ true };
+                CancellationToken cancellation{ pCommand->info.timeout };
+                auto pbRunning = make_shared<atomic<bool>>(true);
+                CommandMetrics::CountersPtr pCounters{ atomic_load(&m_pMetrics)->get(pCommand->info.path) };
+                // The command is kept alive by the task even if it is removed from the registry meanwhile
+                bPosted = m_CommandPool.post([pCommand, terminal = m_rConsole.get().terminal(), vstrArguments = std::move(vstrArguments), cancellation, pbRunning, pCounters]{
+                    ConsoleSession session{ terminal };
+                    session.setInstantPrint(true);
+                    UserCommandData data{ pCommand->info, session, vstrArguments, cancellation };
+                    auto const start = chrono::steady_clock::now();
+                    runCommand(*pCommand, data);
+                    // A cancelled command (Ctrl-C or timeout) is counted as failed
+                    pCounters->recordEnd(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start), cancellation.isCancelled() || data.hasFailed());
+                    *pbRunning = false;
+                }, cancellation);
+                pCounters->recordCall(!bPosted);
+                if (bPosted) {
+                    m_ForegroundCancellation = cancellation;
+                    m_pbForegroundRunning = pbRunning;
+                }
+                if (!bPosted) {
+                    result = Error::TooManyCommands;
+                    m_rConsole.get().printError("Too many commands running, '" + strCommand + "' is not started");
                 }
             }
             else if (Error::EmptyCommand != result) {
@@ -223,6 +322,120 @@ namespace emb {
             return result;
         }
 
+        void Functions::watch(UserCommandData const& a_CmdData) noexcept {
+            chrono::milliseconds interval{ s_DefaultWatchInterval };
+            size_t ulCommandArg{ 0 };
+            if (a_CmdData.args.size() >= 2 && "-n" == a_CmdData.args.at(0)) {
+                char* pEnd{ nullptr };
+                long const lInterval{ strtol(a_CmdData.args.at(1).c_str(), &pEnd, 10) };
+                if (a_CmdData.args.at(1).empty() || '\0' != *pEnd || lInterval <= 0) {
+                    a_CmdData.console.printError("Invalid interval '" + a_CmdData.args.at(1) + "'");
+                    return;
+                }
+                interval = max(chrono::milliseconds{ lInterval }, s_MinWatchInterval);
+                ulCommandArg = 2;
+            }
+            if (ulCommandArg >= a_CmdData.args.size()) {
+                a_CmdData.console.printError("Usage: watch [-n <ms>] <cmd> [args...]");
+                return;
+            }
+
+            CommandRegistry::CommandPtr pCommand{};
+            string const& strCommand{ a_CmdData.args.at(ulCommandArg) };
+            if (Error::NoError != findCommand(pCommand, strCommand, a_CmdData.console.getCurrentPath())) {
+                a_CmdData.console.printError("Cannot find command '" + strCommand + "'");
+                return;
+            }
+            if (pCommand->info.path == a_CmdData.info.path) {
+                a_CmdData.console.printError("A watch cannot watch itself");
+                return;
+            }
+            TerminalPtr const pTerminal{ m_rConsole.get().terminal() };
+            if (!pTerminal->supportsInteractivity()) {
+                a_CmdData.console.printError("watch needs an interactive terminal");
+                return;
+            }
+
+            UserCommandData::Args const vstrArguments(a_CmdData.args.begin() + ulCommandArg + 1, a_CmdData.args.end());
+            string strHeader{ "Every " + to_string(interval.count()) + "ms: " + pCommand->info.path };
+            for (auto const& strArgument : vstrArguments) {
+                strHeader += " " + strArgument;
+            }
+            CommandMetrics::CountersPtr pCounters{ atomic_load(&m_pMetrics)->get(pCommand->info.path) };
+
+            // Lines shown on the screen, compared to the next output so that only the lines that changed are printed
+            vector<string> vstrShownLines{};
+            Terminal::Size shownSize{};
+            bool bFirstRun{ true };
+            a_CmdData.console << Begin() << UseAlternateScreenBuffer(true) << Commit();
+            do {
+                ConsoleSessionCapture session{};
+                UserCommandData data{ pCommand->info, session, vstrArguments, a_CmdData.cancellation };
+                auto const start = chrono::steady_clock::now();
+                runCommand(*pCommand, data);
+                pCounters->recordCall(false);
+                pCounters->recordEnd(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start), a_CmdData.cancellation.isCancelled() || data.hasFailed());
+                if (a_CmdData.cancellation.isCancelled()) {
+                    break;
+                }
+
+                // The output goes from the first row to the row above the command line and the row the cursor is left on
+                Terminal::Size const size{ pTerminal->getCurrentSize() };
+                size_t const ulWidth{ static_cast<size_t>(max(size.iWidth, 1)) };
+                size_t const ulMaxLines{ static_cast<size_t>(max<int>(size.iHeight - static_cast<int>(s_uiWatchFirstRow) - 1, 0)) };
+                vector<string> vstrLines{};
+                string const strOutput{ session.output() };
+                for (size_t ulBegin = 0; ulBegin < strOutput.size() && vstrLines.size() < ulMaxLines;) {
+                    size_t ulEnd{ strOutput.find('\n', ulBegin) };
+                    if (string::npos == ulEnd) {
+                        ulEnd = strOutput.size();
+                    }
+                    // Tabs are expanded so that a line never goes beyond the width of the screen
+                    string strLine{};
+                    for (size_t i = ulBegin; i < ulEnd && strLine.size() < ulWidth; ++i) {
+                        if ('\t' == strOutput[i]) {
+                            strLine.append(8 - strLine.size() % 8, ' ');
+                        }
+                        else if ('\r' != strOutput[i]) {
+                            strLine += strOutput[i];
+                        }
+                    }
+                    if (strLine.size() > ulWidth) {
+                        strLine.resize(ulWidth);
+                    }
+                    vstrLines.push_back(std::move(strLine));
+                    ulBegin = ulEnd + 1;
+                }
+
+                bool const bFullRedraw{ bFirstRun || size != shownSize };
+                if (!bFullRedraw && vstrLines == vstrShownLines) {
+                    // Nothing to print
+                    continue;
+                }
+                a_CmdData.console << Begin();
+                if (bFullRedraw) {
+                    // Everything is printed again on a screen of another size
+                    vstrShownLines.clear();
+                    shownSize = size;
+                    a_CmdData.console << ClearDisplay(ClearDisplay::Type::All) << MoveCursorToPosition(1, 1) << PrintText(strHeader.substr(0, ulWidth));
+                }
+                for (size_t i = 0; i < max(vstrLines.size(), vstrShownLines.size()); ++i) {
+                    bool const bRemoved{ i >= vstrLines.size() };
+                    if (bRemoved || i >= vstrShownLines.size() || vstrLines[i] != vstrShownLines[i]) {
+                        a_CmdData.console << MoveCursorToPosition(s_uiWatchFirstRow + static_cast<unsigned int>(i), 1) << ClearLine(ClearLine::Type::All);
+                        if (!bRemoved) {
+                            a_CmdData.console << PrintText(vstrLines[i]);
+                        }
+                    }
+                }
+                // The command line is drawn below the cursor, which is left under the output
+                a_CmdData.console << MoveCursorToPosition(s_uiWatchFirstRow + static_cast<unsigned int>(ulMaxLines), 1) << Commit();
+                vstrShownLines.swap(vstrLines);
+                bFirstRun = false;
+            } while (!a_CmdData.cancellation.waitFor(interval));
+            a_CmdData.console << Begin() << UseAlternateScreenBuffer(false) << Commit();
+        }
+
         bool Functions::processAutoCompletion(std::string& a_strCurrentEntry, unsigned int& a_uiCurrentCursorPosition, std::string const& a_strCurrentFolder, bool const& a_bNext) noexcept {
             string strAutoCompletionPrefix{ a_strCurrentEntry.substr(0, a_uiCurrentCursorPosition) };
 
@@ -230,6 +443,14 @@ namespace emb {
             if (strAutoCompletionPrefix.find(" ") != std::string::npos) {
                 // Spaces on the left of the cursor, so the auto completion is for command parameters (and not command itself)
                 // We need to transmit the autocompletion data to the command autocompletion function if it exists
+                string const strCacheKey{ a_strCurrentFolder + "\n" + strAutoCompletionPrefix };
+                if (isAutoCompletionPending()) {
+                    lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+                    if (strCacheKey == m_strPendingAutoCompletion) {
+                        // Already running for this entry
+                        return false;
+                    }
+                }
                 if (m_strLastAutoCompletionPrefix != strAutoCompletionPrefix ||
                     (-1ULL == m_ullAutoCompletionPosition && strAutoCompletionPrefix.empty())) {
                     m_strLastAutoCompletionPrefix = strAutoCompletionPrefix;
@@ -239,14 +460,18 @@ namespace emb {
 
                     string word = m_strLastAutoCompletionPrefix.substr(m_strLastAutoCompletionPrefix.find_last_of(' ') + 1);
 
-                    Functor f;
+                    CommandRegistry::CommandPtr pCommand{};
                     string strCommand{};
                     vector<string> vstrArguments{};
-                    Error result{ searchCommand(f, strCommand, vstrArguments, m_strLastAutoCompletionPrefixWithoutPartialArg, a_strCurrentFolder) };
-
-                    if (Error::NoError == result && f.fa) {
-                        UserCommandAutoCompleteData data{ vstrArguments, word };
-                        m_vstrAutoCompletionChoices = f.fa(data);
+                    Error result{ searchCommand(pCommand, strCommand, vstrArguments, m_strLastAutoCompletionPrefixWithoutPartialArg, a_strCurrentFolder) };
+
+                    // The entry changed: a completion still running for the previous one is useless
+                    cancelAutoCompletion();
+                    if (Error::NoError == result && pCommand->autoComplete && !getCachedAutoCompletion(strCacheKey, m_vstrAutoCompletionChoices)) {
+                        // The completer may be slow: it runs in the background, and the next call for this entry is answered
+                        // by the cache once it is done
+                        startAutoCompletion(strCacheKey, pCommand->autoComplete, vstrArguments, word);
+                        m_strLastAutoCompletionPrefix.clear();
                     }
                 }
                 else {
@@ -322,81 +547,236 @@ namespace emb {
             return bRes;
         }
 
+        Functions::AutoCompletionState Functions::pollAutoCompletion() noexcept {
+            lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+            if (m_strPendingAutoCompletion.empty()) {
+                return AutoCompletionState::None;
+            }
+            AutoCompletionState eRes{ AutoCompletionState::Pending };
+            auto const itCached = m_mapAutoCompletionCache.find(m_strPendingAutoCompletion);
+            if (m_mapAutoCompletionCache.end() != itCached) {
+                eRes = AutoCompletionState::Ready;
+            }
+            else if (chrono::steady_clock::now() >= m_PendingAutoCompletionDeadline) {
+                m_PendingAutoCompletionCancellation.cancel();
+                eRes = AutoCompletionState::TimedOut;
+            }
+            if (AutoCompletionState::Pending != eRes) {
+                m_strPendingAutoCompletion.clear();
+                m_PendingAutoCompletionDeadline = chrono::steady_clock::time_point::max();
+            }
+            return eRes;
+        }
+
+        bool Functions::cancelAutoCompletion() noexcept {
+            lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+            if (m_strPendingAutoCompletion.empty()) {
+                return false;
+            }
+            m_PendingAutoCompletionCancellation.cancel();
+            m_strPendingAutoCompletion.clear();
+            m_PendingAutoCompletionDeadline = chrono::steady_clock::time_point::max();
+            return true;
+        }
+
+        bool Functions::isAutoCompletionPending() const noexcept {
+            lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+            return !m_strPendingAutoCompletion.empty();
+        }
+
+        chrono::steady_clock::time_point Functions::getAutoCompletionDeadline() const noexcept {
+            lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+            return m_PendingAutoCompletionDeadline;
+        }
+
+        void Functions::setAutoCompletionReadyEvt(function<void(void)> const& a_fctReady) noexcept {
+            lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+            m_fctAutoCompletionReady = a_fctReady;
+        }
+
+        bool Functions::getCachedAutoCompletion(string const& a_strPrefix, vector<string>& a_rvstrChoices) noexcept {
+            lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+            auto const it = m_mapAutoCompletionCache.find(a_strPrefix);
+            if (m_mapAutoCompletionCache.end() == it) {
+                return false;
+            }
+            if (chrono::steady_clock::now() >= it->second.expiry) {
+                m_mapAutoCompletionCache.erase(it);
+                return false;
+            }
+            a_rvstrChoices = it->second.vstrChoices;
+            return true;
+        }
+
+        bool Functions::startAutoCompletion(string const& a_strPrefix, UserCommandAutoCompleteFunctor const& a_funcAutoComplete,
+                                            UserCommandAutoCompleteData::Args const& a_vstrArguments, string const& a_strPartialArg) noexcept {
+            CancellationToken cancellation{ s_AutoCompletionTimeout };
+            UserCommandAutoCompleteData data{ a_vstrArguments, a_strPartialArg, cancellation };
+            bool const bRes{ m_AutoCompletionPool.post([this, a_funcAutoComplete, data, a_strPrefix] {
+                vector<string> vstrChoices{};
+                try {
+                    vstrChoices = a_funcAutoComplete(data);
+                }
+                catch (...) {
+                    // A completer that fails proposes nothing
+                }
+                lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+                // A cancelled completer may have stopped early: its results are not reliable
+                if (data.cancellation.isCancelled()) {
+                    return;
+                }
+                auto const now = chrono::steady_clock::now();
+                if (m_mapAutoCompletionCache.size() >= s_ulMaxCachedAutoCompletions) {
+                    // Drops the expired results, or the oldest ones
+                    auto itOldest = m_mapAutoCompletionCache.begin();
+                    for (auto it = m_mapAutoCompletionCache.begin(); it != m_mapAutoCompletionCache.end();) {
+                        if (now >= it->second.expiry) {
+                            it = m_mapAutoCompletionCache.erase(it);
+                            itOldest = m_mapAutoCompletionCache.begin();
+                        }
+                        else {
+                            if (it->second.expiry < itOldest->second.expiry) {
+                                itOldest = it;
+                            }
+                            ++it;
+                        }
+                    }
+                    if (m_mapAutoCompletionCache.size() >= s_ulMaxCachedAutoCompletions) {
+                        m_mapAutoCompletionCache.erase(itOldest);
+                    }
+                }
+                CachedChoices& rCached = m_mapAutoCompletionCache[a_strPrefix];
+                rCached.vstrChoices = std::move(vstrChoices);
+                rCached.expiry = now + s_AutoCompletionCacheDuration;
+                if (a_strPrefix == m_strPendingAutoCompletion && m_fctAutoCompletionReady) {
+                    m_fctAutoCompletionReady();
+                }
+            }, cancellation) };
+            if (bRes) {
+                lock_guard<mutex> const lock{ m_AutoCompletionMutex };
+                m_strPendingAutoCompletion = a_strPrefix;
+                m_PendingAutoCompletionCancellation = cancellation;
+                m_PendingAutoCompletionDeadline = chrono::steady_clock::now() + s_AutoCompletionTimeout;
+            }
+            return bRes;
+        }
+
+        bool Functions::cancelForegroundCommand() noexcept {
+            if (!m_pbForegroundRunning || !*m_pbForegroundRunning) {
+                return false;
+            }
+            return m_ForegroundCancellation.cancel();
+        }
+
+        void Functions::cancelCommands() noexcept {
+            m_CommandPool.cancelAll();
+            m_AutoCompletionPool.cancelAll();
+        }
+
+        void Functions::stopCommands() noexcept {
+            cancelCommands();
+            m_CommandPool.stop();
+            m_AutoCompletionPool.stop();
+        }
+
         bool Functions::folderExists(std::string const& a_strFolder) const noexcept {
-            string strFolderToTest = getCanonicalPath(a_strFolder, true);
-            for (auto const& elm : m_mapFunctions) {
-                if(elm.first.find(strFolderToTest) == 0) {
+            // A folder exists if at least one command is under it
+            Snapshots const snapshots{ getSnapshots() };
+            string const strFolder{ getCanonicalPath(a_strFolder) };
+            for (CommandRegistry::Snapshot const* pSnapshot : { snapshots.pCommon.get(), snapshots.pLocal.get() }) {
+                CommandRegistry::Node const* pNode = pSnapshot->findNode(strFolder);
+                if (nullptr != pNode && !pNode->mapChildren.empty()) {
                     return true;
                 }
             }
             return false;
         }
 
-        std::vector<Functions::LocalCommandInfo> Functions::getCommands(std::string const& a_strCurrentPath) const noexcept {
-            std::vector<LocalCommandInfo> vecCmds{};
+        std::vector<Functions::LocalCommandInfo> Functions::getCommands(std::string const& a_strCurrentPath, std::string const& a_strPrefix) const noexcept {
+            // Commands of the application first: a command of the terminal with the same name is hidden by it
+            Snapshots const snapshots{ getSnapshots() };
+            string const strCurrentPath{ getCanonicalPath(a_strCurrentPath) };
+            map<string, LocalCommandInfo> mapRoot{};
+            map<string, LocalCommandInfo> mapLocal{};
+            for (CommandRegistry::Snapshot const* pSnapshot : { snapshots.pCommon.get(), snapshots.pLocal.get() }) {
+                // Root commands are the commands directly in the root folder => available from anywhere
+                auto const rangeRoot = prefixRange(pSnapshot->root().mapChildren, a_strPrefix);
+                for (auto it = rangeRoot.first; it != rangeRoot.second; ++it) {
+                    if (nullptr != it->second->pCommand) {
+                        LocalCommandInfo i;
+                        i.bIsDirectory = false;
+                        i.bIsRoot = true;
+                        i.strName = it->first;
+                        i.strDescription = it->second->pCommand->info.description;
+                        mapRoot.emplace(i.strName, i);
+                    }
+                }
 
-            for (auto const& elm : m_mapFunctions) {
-                if (isRootCommand(elm.first)) { // root command => available from anywhere
-                    LocalCommandInfo i;
-                    i.bIsDirectory = false;
-                    i.bIsRoot = true;
-                    i.strName = elm.first.substr(1);
-                    i.strDescription = elm.second.i.description;
-                    vecCmds.push_back(i);
-                }
-            }
-
-            vector<string> vecPrintedFolders;
-            for (auto const& elm : m_mapFunctions) {
-                if(!isRootCommand(elm.first) &&
-                    isSubCommandOf(elm.first, a_strCurrentPath)) { // Other command => available from folder
-                    string folder = getLocalName(elm.first, a_strCurrentPath);
-                    if(std::count(vecPrintedFolders.begin(), vecPrintedFolders.end(), folder) == 0) {
-                        vecPrintedFolders.push_back(folder);
-                        if(string::npos == folder.find('/')) { // command
+                // Other commands => available from their folder, an element having children is also listed as a folder
+                CommandRegistry::Node const* pNode = pSnapshot->findNode(strCurrentPath);
+                if (nullptr != pNode) {
+                    auto const rangeLocal = prefixRange(pNode->mapChildren, a_strPrefix);
+                    for (auto it = rangeLocal.first; it != rangeLocal.second; ++it) {
+                        if (nullptr != it->second->pCommand && pNode != &pSnapshot->root()) { // command
                             LocalCommandInfo i;
                             i.bIsDirectory = false;
                             i.bIsRoot = false;
-                            i.strName = folder;
-                            i.strDescription = elm.second.i.description;
-                            vecCmds.push_back(i);
+                            i.strName = it->first;
+                            i.strDescription = it->second->pCommand->info.description;
+                            mapLocal.emplace(i.strName, i);
                         }
-                        else { // folder
+                        if (!it->second->mapChildren.empty()) { // folder
                             LocalCommandInfo i;
                             i.bIsDirectory = true;
                             i.bIsRoot = false;
-                            i.strName = folder;
-                            i.strDescription = elm.second.i.description;
-                            vecCmds.push_back(i);
+                            i.strName = it->first + "/";
+                            mapLocal.emplace(i.strName, i);
                         }
                     }
                 }
             }
 
+            // Each group sorted by name, local entries as their complete path: "b-c" comes before the folder "b/"
+            std::vector<LocalCommandInfo> vecCmds{};
+            vecCmds.reserve(mapRoot.size() + mapLocal.size());
+            for (auto& elm : mapRoot) {
+                vecCmds.push_back(std::move(elm.second));
+            }
+            for (auto& elm : mapLocal) {
+                vecCmds.push_back(std::move(elm.second));
+            }
+
             return vecCmds;
         }
 
-        Functions::Error Functions::extractElementsFromUserEntry(string& a_rstrCommand, vector<string>& a_rvstrArguments, string const& a_strUserEntry) const noexcept {
+        Functions::Error Functions::extractElementsFromUserEntry(ParsedEntry& a_rEntry, string const& a_strUserEntry) const noexcept {
             enum class Token
             {
                 Command,
                 Arguments
             } token = Token::Command;
-            unsigned int uiIdxArg{ 0 };
+            bool bArgumentOpen{ false };
             char cQuote{ 0 };
 
+            // The entry cannot grow while it is unquoted and unescaped: the buffer is never reallocated while parsing
+            a_rEntry.strBuffer.clear();
+            a_rEntry.strBuffer.reserve(a_strUserEntry.size());
+            a_rEntry.command = ParsedEntry::Slice{};
+            a_rEntry.vArguments.clear();
+
             auto addCharToArguments = [&](char c) {
-                if (a_rvstrArguments.size() <= uiIdxArg) {
-                    a_rvstrArguments.push_back(std::string());
-                }
-                a_rvstrArguments[uiIdxArg] += c;
+                if (!bArgumentOpen) {
+                    ParsedEntry::Slice argument{};
+                    argument.ulOffset = a_rEntry.strBuffer.size();
+                    a_rEntry.vArguments.push_back(argument);
+                    bArgumentOpen = true;
+                }
+                a_rEntry.strBuffer += c;
+                ++a_rEntry.vArguments.back().ulSize;
             };
             auto goToNextArgument = [&]() {
-                if (uiIdxArg < a_rvstrArguments.size()) {
-                    if (!a_rvstrArguments[uiIdxArg].empty()) {
-                        ++uiIdxArg;
-                    }
-                }
+                // An argument is only created by its first character, so an open argument is never empty
+                bArgumentOpen = false;
             };
 
             char c_prev{ 0 };
@@ -438,7 +818,8 @@ namespace emb {
                 }
                 else {
                     if (Token::Command == token) {
-                        a_rstrCommand += c;
+                        a_rEntry.strBuffer += c;
+                        ++a_rEntry.command.ulSize;
                     }
                     else if (Token::Arguments == token) {
                         addCharToArguments(c);
@@ -450,43 +831,46 @@ namespace emb {
             return 0 == cQuote ? Error::NoError : Error::QuoteNotClosed;
         }
 
-        Functions::Error Functions::searchCommand(Functor& a_rFunctor, string& a_rstrCommand, vector<string>& a_rvstrArguments,
-                                                  string const& a_strUserEntry, string const& a_strPath) const noexcept {
+        Functions::Error Functions::findCommand(CommandRegistry::CommandPtr& a_rpCommand, string const& a_strCommand, string const& a_strPath) const noexcept {
             Error result{ Error::NoError };
+            Snapshots const snapshots{ getSnapshots() };
+            CommandRegistry::CommandPtr pCommand{};
+            if (isAbsolutePath(a_strCommand)) {
+                pCommand = snapshots.find(getCanonicalPath(a_strCommand));
+            }
+            else { // relative path
+                pCommand = snapshots.find(getCanonicalPath(a_strPath + "/" + a_strCommand));
+                if (!pCommand && isSimpleCommand(a_strCommand)) {
+                    pCommand = snapshots.find("/" + a_strCommand);
+                }
+            }
+            if (pCommand) {
+                a_rpCommand = std::move(pCommand);
+                result = Error::NoError;
+            }
+            else if (!a_strCommand.empty()) {
+                result = Error::CommandNotFound;
+            }
+            else {
+                result = Error::EmptyCommand;
+            }
+            return result;
+        }
 
-            result = extractElementsFromUserEntry(a_rstrCommand, a_rvstrArguments, a_strUserEntry);
+        Functions::Error Functions::searchCommand(CommandRegistry::CommandPtr& a_rpCommand, string& a_rstrCommand, vector<string>& a_rvstrArguments,
+                                                  string const& a_strUserEntry, string const& a_strPath) const noexcept {
+            ParsedEntry entry{};
+            Error result{ extractElementsFromUserEntry(entry, a_strUserEntry) };
+
+            // Each argument is copied once from its slice
+            a_rstrCommand.assign(entry.strBuffer, entry.command.ulOffset, entry.command.ulSize);
+            a_rvstrArguments.reserve(a_rvstrArguments.size() + entry.vArguments.size());
+            for (auto const& argument : entry.vArguments) {
+                a_rvstrArguments.emplace_back(entry.strBuffer, argument.ulOffset, argument.ulSize);
+            }
 
             if (Error::NoError == result) {
-                auto it = m_mapFunctions.end();
-                if (isAbsolutePath(a_rstrCommand)) {
-                    auto it1 = m_mapFunctions.find(getCanonicalPath(a_rstrCommand));
-                    if (it1 != m_mapFunctions.end()) {
-                        it = it1;
-                    }
-                }
-                else { // relative path
-                    string fullPath{ getCanonicalPath(a_strPath + "/" + a_rstrCommand) };
-                    auto it1 = m_mapFunctions.find(fullPath);
-                    if (it1 != m_mapFunctions.end()) {
-                        it = it1;
-                    }
-                    else if (isSimpleCommand(a_rstrCommand)) {
-                        auto it2 = m_mapFunctions.find("/" + a_rstrCommand);
-                        if (it2 != m_mapFunctions.end()) {
-                            it = it2;
-                        }
-                    }
-                }
-                if (it != m_mapFunctions.end()) {
-                    a_rFunctor = it->second;
-                    result = Error::NoError;
-                }
-                else if (!a_rstrCommand.empty()) {
-                    result = Error::CommandNotFound;
-                }
-                else {
-                    result = Error::EmptyCommand;
-                }
+                result = findCommand(a_rpCommand, a_rstrCommand, a_strPath);
             }
 
             return result;
@@ -522,16 +906,13 @@ namespace emb {
                 }
             }
 
-            // We search the commands available from the current folder
-            auto vecLocalCommands = getCommands(strCurrentFolder);
+            // We search the commands available from the current folder that start with strPartialCmd
+            auto vecLocalCommands = getCommands(strCurrentFolder, strPartialCmd);
 
-            // We filter the found command and only keep the directories that start with strPartialCmd
             for(auto const& elm : vecLocalCommands) {
-                if(0 == elm.strName.find(strPartialCmd)) {
-                    // We filter the root commands when using a full path
-                    if(strPrefixFolder.empty() || (!strPrefixFolder.empty() && !elm.bIsRoot) || (strCurrentFolder == "/" && elm.bIsRoot)) {
-                        vecChoices.push_back(strPrefixFolder + elm.strName);
-                    }
+                // We filter the root commands when using a full path
+                if(strPrefixFolder.empty() || (!strPrefixFolder.empty() && !elm.bIsRoot) || (strCurrentFolder == "/" && elm.bIsRoot)) {
+                    vecChoices.push_back(strPrefixFolder + elm.strName);
                 }
             }
 
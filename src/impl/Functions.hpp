@@ -1,9 +1,15 @@
 #pragma once
 #include "EmbConsole.hpp"
+#include "CommandPool.hpp"
+#include "CommandRegistry.hpp"
+#include "CommandMetrics.hpp"
 #include <string>
 #include <map>
 #include <vector>
-#include <future>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
 
 namespace emb {
     namespace console {
@@ -20,7 +26,8 @@ namespace emb {
                 NoError,            ///< No error
                 QuoteNotClosed,     ///< An open quote (" or ') was not closed
                 CommandNotFound,    ///< Command is not found in the list of locally available commands
-                EmptyCommand        ///< Typed command is empty
+                EmptyCommand,       ///< Typed command is empty
+                TooManyCommands     ///< Too many commands are already running or waiting to run
             };
             /**
              * @brief Represents what a user typed in the console before it is processed
@@ -40,6 +47,15 @@ namespace emb {
                 std::string strDescription{};   ///< Description of the command
             };
             using VLocalCommandInfo = std::vector<LocalCommandInfo>;
+            /**
+             * @brief State of the autocompletion of arguments, run in the background
+             */
+            enum class AutoCompletionState {
+                None,       ///< No completion running
+                Pending,    ///< The completer is still running
+                Ready,      ///< The results are available: processAutoCompletion() gives them
+                TimedOut    ///< The completer did not answer in time, it has been cancelled
+            };
 
         // public static methods
         public:
@@ -88,6 +104,13 @@ namespace emb {
              * @return std::string  Canonical path
              */
             static std::string getCanonicalPath(std::string const& a_strPath, bool a_bEndWithDelimiter = false) noexcept;
+            /**
+             * @brief Runs the function of a command. An exception thrown by the command is printed as an error on the console
+             *        of the data, and the command is marked as failed.
+             * @param a_Command     Command to run
+             * @param a_Data        Data given to the command
+             */
+            static void runCommand(UserCommand const& a_Command, UserCommandData const& a_Data) noexcept;
 
         public:
             Functions(ConsoleSessionWithTerminal&) noexcept;
@@ -97,60 +120,175 @@ namespace emb {
             Functions& operator= (Functions const&) = delete;
             Functions& operator= (Functions&&) noexcept = delete;
 
+            /**
+             * @brief Sets the commands of the application, shared with the other terminals. They take precedence over the
+             *        commands of the terminal with the same paths.
+             */
+            void setCommonCommands(std::shared_ptr<CommandRegistry> const& a_pCommands) noexcept;
+            /**
+             * @brief Sets the execution counters of the commands, shared with the other terminals
+             */
+            void setCommandMetrics(std::shared_ptr<CommandMetrics> const& a_pMetrics) noexcept;
+            /// Commands of the terminal only
             void addCommand(UserCommandInfo const&, UserCommandFunctor0 const&, UserCommandAutoCompleteFunctor const& = nullptr) noexcept;
             void addCommand(UserCommandInfo const&, UserCommandFunctor1 const&, UserCommandAutoCompleteFunctor const& = nullptr) noexcept;
             void delCommand(UserCommandInfo const&) noexcept;
             void delAllCommands() noexcept;
 
-            Error processEntry(UserEntry const& a_UserEntry) noexcept;
+            Error processEntry(UserEntry a_UserEntry) noexcept;
+            /**
+             * @brief Completes the command or the argument being typed. The completers of the arguments run in the background:
+             *        when their results are not known yet, nothing is changed and pollAutoCompletion() tells when they are.
+             * @return bool     True if the entry has been changed
+             */
             bool processAutoCompletion(std::string& a_strCurrentEntry, unsigned int& a_uiCurrentCursorPosition,
                                        std::string const& a_strCurrentFolder, bool const& a_bNext) noexcept;
+            /**
+             * @brief Gives the state of the completion running in the background. Ready and TimedOut are given once, the
+             *        completion is then over.
+             */
+            AutoCompletionState pollAutoCompletion() noexcept;
+            /**
+             * @brief Cancels the completion running in the background, because the entry changed
+             * @return bool     False if no completion was running
+             */
+            bool cancelAutoCompletion() noexcept;
+            bool isAutoCompletionPending() const noexcept;
+            /**
+             * @brief Gives the time at which the completion running in the background times out, time_point::max() if none
+             */
+            std::chrono::steady_clock::time_point getAutoCompletionDeadline() const noexcept;
+            /**
+             * @brief Sets the function called by a background completion when its results are available
+             */
+            void setAutoCompletionReadyEvt(std::function<void(void)> const& a_fctReady) noexcept;
+            /**
+             * @brief Cancels the foreground command: the last command started by processEntry(), if it is still running
+             * @return bool     False if there is no foreground command running, or if it was already cancelled
+             */
+            bool cancelForegroundCommand() noexcept;
+            /**
+             * @brief Cancels all the commands and completions, waiting or running
+             */
+            void cancelCommands() noexcept;
+            /**
+             * @brief Tells if commands started from the terminal are waiting or running
+             */
+            bool hasRunningCommands() const noexcept { return m_CommandPool.busy(); }
+            /**
+             * @brief Cancels all the commands and completions, then waits for them to end. No other command is started.
+             */
+            void stopCommands() noexcept;
 
             bool folderExists(std::string const&) const noexcept;
-            VLocalCommandInfo getCommands(std::string const& a_strCurrentPath) const noexcept;
+            /**
+             * @brief Gives the commands available from a path: the root commands, then the commands and folders of the path
+             * @param a_strCurrentPath  Path to search the commands into
+             * @param a_strPrefix       Only the commands and folders whose name starts with this prefix are given
+             * @return VLocalCommandInfo    Commands found, each group sorted by name
+             */
+            VLocalCommandInfo getCommands(std::string const& a_strCurrentPath, std::string const& a_strPrefix = "") const noexcept;
 
         // private types
         private:
-            struct Functor {
-                UserCommandInfo i;
-                UserCommandFunctor0 f0;
-                UserCommandFunctor1 f1;
-                UserCommandAutoCompleteFunctor fa;
+            /**
+             * @brief Snapshots of the commands visible from the terminal, taken once for a whole search
+             */
+            struct Snapshots {
+                CommandRegistry::SnapshotPtr pCommon{};     ///< Commands of the application
+                CommandRegistry::SnapshotPtr pLocal{};      ///< Commands of the terminal
+                /**
+                 * @brief Gives a command from its canonical path, the commands of the application first
+                 */
+                CommandRegistry::CommandPtr find(std::string const& a_strCanonicalPath) const noexcept;
+            };
+            /**
+             * @brief User entry split into a command and its arguments. Quotes and escapes are resolved into a single buffer,
+             *        the command and each argument being a slice of it.
+             */
+            struct ParsedEntry {
+                struct Slice {
+                    size_t ulOffset{ 0 };
+                    size_t ulSize{ 0 };
+                };
+                std::string strBuffer{};            ///< Command then arguments, unquoted and unescaped, back to back
+                Slice command{};                    ///< Command, always at the beginning of the buffer
+                std::vector<Slice> vArguments{};    ///< Arguments, in order
+            };
+            struct CachedChoices {
+                std::vector<std::string> vstrChoices{};
+                std::chrono::steady_clock::time_point expiry{};
             };
 
         // private methods
         private:
             /**
-             * @brief Tries to extract element from a user entry. Extracted elements are : the command, and the arguments.
-             * @param a_rstrCommand     Extracted command from the entry
-             * @param a_rvstrArguments  Vector of arguments extacted from the entry.
+             * @brief Tries to extract element from a user entry, in a single pass. Extracted elements are : the command, and the arguments.
+             * @param a_rEntry          Extracted command and arguments
              * @param a_strUserEntry    Input User entry
              * @return Error    Resulting error indicating if the extraction went well
              */
-            Error extractElementsFromUserEntry(std::string& a_rstrCommand, std::vector<std::string>& a_rvstrArguments,
-                                             std::string const& a_strUserEntry) const noexcept;
+            Error extractElementsFromUserEntry(ParsedEntry& a_rEntry, std::string const& a_strUserEntry) const noexcept;
+            Snapshots getSnapshots() const noexcept;
+            /**
+             * @brief Tries to find a command from its absolute or relative path
+             * @param a_rpCommand       Found command
+             * @param a_strCommand      Path of the command
+             * @param a_strPath         Current path
+             * @return Error    NoError, CommandNotFound or EmptyCommand
+             */
+            Error findCommand(CommandRegistry::CommandPtr& a_rpCommand, std::string const& a_strCommand, std::string const& a_strPath) const noexcept;
             /**
              * @brief Tries to find a command matching a user entry
-             * @param a_rFunctor        Functor information from the found command
+             * @param a_rpCommand       Found command
              * @param a_rstrCommand     Extracted command from the entry
              * @param a_rvstrArguments  Vector of arguments extacted from the entry.
              * @param a_strUserEntry    Input User entry
              * @param a_strPath         Current path
              * @return Error    Resulting error indicating if the extraction went well
              */
-            Error searchCommand(Functor& a_rFunctor, std::string& a_rstrCommand, std::vector<std::string>& a_rvstrArguments,
+            Error searchCommand(CommandRegistry::CommandPtr& a_rpCommand, std::string& a_rstrCommand, std::vector<std::string>& a_rvstrArguments,
                                 std::string const& a_strUserEntry, std::string const& a_strPath) const noexcept;
 
             std::vector<std::string> getAutoCompleteChoices(std::string const& a_strPartialCmd, std::string const& a_strCurrentFolder) const noexcept;
+            /**
+             * @brief Executes a command periodically until it is cancelled (built-in "watch"). Its output is shown on the
+             *        alternate screen, and only the lines that changed since the previous execution are printed again.
+             */
+            void watch(UserCommandData const& a_CmdData) noexcept;
+
+            /**
+             * @brief Gives the cached results of a completer, if they are still fresh
+             * @return bool     True if found
+             */
+            bool getCachedAutoCompletion(std::string const& a_strPrefix, std::vector<std::string>& a_rvstrChoices) noexcept;
+            /**
+             * @brief Runs a completer in the background, its results are cached
+             * @return bool     False if too many completers are already running
+             */
+            bool startAutoCompletion(std::string const& a_strPrefix, UserCommandAutoCompleteFunctor const& a_funcAutoComplete,
+                                     UserCommandAutoCompleteData::Args const& a_vstrArguments, std::string const& a_strPartialArg) noexcept;
 
         private:
             std::reference_wrapper<ConsoleSessionWithTerminal> m_rConsole;
-            std::map<std::string, Functor> m_mapFunctions;
-            std::future<void> m_future;
+            std::shared_ptr<CommandRegistry> m_pCommonCommands;     ///< Only accessed with the atomic shared_ptr functions
+            CommandRegistry m_LocalCommands{};
+            std::shared_ptr<CommandMetrics> m_pMetrics;     ///< Only accessed with the atomic shared_ptr functions
             std::string m_strLastAutoCompletionPrefix{};
             std::string m_strLastAutoCompletionPrefixWithoutPartialArg{};
             size_t m_ullAutoCompletionPosition{ -1ULL };
             std::vector<std::string> m_vstrAutoCompletionChoices{};
+            CancellationToken m_ForegroundCancellation{};                   ///< Token of the last command started
+            std::shared_ptr<std::atomic<bool>> m_pbForegroundRunning{};     ///< Cleared when the last command started ends
+            mutable std::mutex m_AutoCompletionMutex{};
+            std::map<std::string, CachedChoices> m_mapAutoCompletionCache{};   ///< Results of the completers, by entry prefix
+            std::string m_strPendingAutoCompletion{};                           ///< Prefix of the running completion, empty if none
+            CancellationToken m_PendingAutoCompletionCancellation{};
+            std::chrono::steady_clock::time_point m_PendingAutoCompletionDeadline{ std::chrono::steady_clock::time_point::max() };
+            std::function<void(void)> m_fctAutoCompletionReady{};
+            // Last members: running commands and completions end before the rest is destroyed
+            CommandPool m_AutoCompletionPool;
+            CommandPool m_CommandPool;
         };
     } // console
 } // emb
@@ -0,0 +1,113 @@
+#include "InputStreams.hpp"
+#include <algorithm>
+#include <cerrno>
+#ifdef unix
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+namespace emb {
+    namespace console {
+        using namespace std;
+
+        static size_t const s_ulMaxLineSize{ 64 * 1024 };  ///< A longer line is printed in several parts
+        static size_t const s_ulMaxBytesByProcess{ 64 * 1024 };    ///< Read from a stream by an iteration of the event loop
+        static size_t const s_ulMaxLinesByCall{ 256 };     ///< Lines given at once, i.e. printed in a single transaction
+
+        bool InputStreams::add(string const& a_strName, int const a_iFd) noexcept {
+#ifdef unix
+            if (a_iFd < 0) {
+                return false;
+            }
+            lock_guard<mutex> const lock{ m_Mutex };
+            auto const it = find_if(m_vStreams.begin(), m_vStreams.end(), [&a_strName](Stream const& a_Stream) { return a_strName == a_Stream.strName; });
+            if (m_vStreams.end() != it) {
+                return false;
+            }
+            fcntl(a_iFd, F_SETFL, fcntl(a_iFd, F_GETFL) | O_NONBLOCK);
+            Stream stream{};
+            stream.strName = a_strName;
+            stream.iFd = a_iFd;
+            m_vStreams.push_back(std::move(stream));
+            return true;
+#else
+            // Windows handles are not waitable by the event loop
+            (void)a_strName;
+            (void)a_iFd;
+            return false;
+#endif
+        }
+
+        bool InputStreams::remove(string const& a_strName) noexcept {
+            lock_guard<mutex> const lock{ m_Mutex };
+            auto const it = find_if(m_vStreams.begin(), m_vStreams.end(), [&a_strName](Stream const& a_Stream) { return a_strName == a_Stream.strName; });
+            if (m_vStreams.end() == it) {
+                return false;
+            }
+            m_vStreams.erase(it);
+            return true;
+        }
+
+        void InputStreams::appendFds(vector<int>& a_rviFds) const noexcept {
+            lock_guard<mutex> const lock{ m_Mutex };
+            for (Stream const& stream : m_vStreams) {
+                a_rviFds.push_back(stream.iFd);
+            }
+        }
+
+        void InputStreams::process(LinesFunctor const& a_funcLines) noexcept {
+#ifdef unix
+            // The lines are given once the lock is released: the functor prints, and may wait
+            vector<Lines> vLines{};
+            auto const addLine = [&vLines](string const& a_strName, string&& a_strLine) {
+                if (vLines.empty() || vLines.back().strName != a_strName || vLines.back().vstrLines.size() >= s_ulMaxLinesByCall) {
+                    vLines.push_back(Lines{ a_strName, {} });
+                }
+                vLines.back().vstrLines.push_back(std::move(a_strLine));
+            };
+            {
+                lock_guard<mutex> const lock{ m_Mutex };
+                char acBuffer[4096];
+                for (auto it = m_vStreams.begin(); it != m_vStreams.end();) {
+                    Stream& rStream = *it;
+                    size_t ulRead{ 0 };
+                    ssize_t lRead{ 0 };
+                    // What is left is read by the next iteration of the event loop, the descriptor staying readable
+                    while (ulRead < s_ulMaxBytesByProcess &&
+                        ((lRead = read(rStream.iFd, acBuffer, min(sizeof(acBuffer), s_ulMaxBytesByProcess - ulRead))) > 0 || (lRead < 0 && EINTR == errno))) {
+                        for (ssize_t i = 0; i < lRead; ++i) {
+                            char const c{ acBuffer[i] };
+                            if ('\n' == c) {
+                                addLine(rStream.strName, std::move(rStream.strPending));
+                                rStream.strPending.clear();
+                            }
+                            else if ('\r' != c) {
+                                rStream.strPending += c;
+                                if (rStream.strPending.size() >= s_ulMaxLineSize) {
+                                    addLine(rStream.strName, std::move(rStream.strPending));
+                                    rStream.strPending.clear();
+                                }
+                            }
+                        }
+                        if (lRead > 0) {
+                            ulRead += static_cast<size_t>(lRead);
+                        }
+                    }
+                    // End of file, or the descriptor is not readable anymore (closed, error)
+                    bool const bEnd{ 0 == lRead || (lRead < 0 && EAGAIN != errno && EWOULDBLOCK != errno) };
+                    if (bEnd && !rStream.strPending.empty()) {
+                        addLine(rStream.strName, std::move(rStream.strPending));
+                        rStream.strPending.clear();
+                    }
+                    it = bEnd ? m_vStreams.erase(it) : it + 1;
+                }
+            }
+            for (Lines const& lines : vLines) {
+                a_funcLines(lines.strName, lines.vstrLines);
+            }
+#else
+            (void)a_funcLines;
+#endif
+        }
+    } // console
+} // emb
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <functional>
+
+namespace emb {
+    namespace console {
+        /**
+         * @brief Named file descriptors (pipes, pty masters, sockets...) whose output is printed on the console.
+         *        The descriptors are polled by the console event loop and read by the console thread, without any thread
+         *        per stream.
+         */
+        class InputStreams {
+        public:
+            /// Receives the complete lines read from a stream
+            using LinesFunctor = std::function<void(std::string const& a_strName, std::vector<std::string> const& a_vstrLines)>;
+
+        public:
+            InputStreams() noexcept = default;
+            InputStreams(InputStreams const&) = delete;
+            InputStreams(InputStreams&&) = delete;
+            ~InputStreams() noexcept = default;
+            InputStreams& operator= (InputStreams const&) = delete;
+            InputStreams& operator= (InputStreams&&) = delete;
+
+            /**
+             * @brief Adds a stream. The descriptor is switched to non-blocking mode, it is not closed by the console.
+             * @param a_strName     Name of the stream
+             * @param a_iFd         Descriptor to read
+             * @return bool         False if the name is already used, or if streams are not supported on the platform
+             */
+            bool add(std::string const& a_strName, int const a_iFd) noexcept;
+            /**
+             * @brief Removes a stream, without reading what is left
+             * @param a_strName     Name of the stream
+             * @return bool         False if there is no stream with this name
+             */
+            bool remove(std::string const& a_strName) noexcept;
+
+            /**
+             * @brief Appends the descriptors of the streams to the descriptors the event loop waits for
+             */
+            void appendFds(std::vector<int>& a_rviFds) const noexcept;
+            /**
+             * @brief Reads the streams without blocking, a bounded amount of each stream so that a fast producer does not
+             *        hold the console thread: the rest is read by the next call. Streams at their end are removed.
+             * @param a_funcLines   Called with bounded groups of the complete lines read from a stream, and the last partial
+             *                      line at the end. Called without holding the lock of the streams.
+             */
+            void process(LinesFunctor const& a_funcLines) noexcept;
+
+        private:
+            struct Lines {
+                std::string strName{};
+                std::vector<std::string> vstrLines{};
+            };
+            struct Stream {
+                std::string strName{};
+                int iFd{ -1 };
+                std::string strPending{};   ///< Beginning of a line not complete yet
+            };
+
+        private:
+            mutable std::mutex m_Mutex{};
+            std::vector<Stream> m_vStreams{};
+        };
+    } // console
+} // emb
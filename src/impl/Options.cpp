@@ -25,6 +25,8 @@ namespace emb {
             m_vpOptions.push_back(std::make_shared<OptionUnixSocket>());
             m_vpOptions.push_back(std::make_shared<OptionLocalTcpServer>());
             m_vpOptions.push_back(std::make_shared<OptionSyslog>());
+            m_vpOptions.push_back(std::make_shared<OptionEventLoop>());
+            m_vpOptions.push_back(std::make_shared<OptionHistory>());
         }
 
         Options::Options(Option const& a_other) : Options() {
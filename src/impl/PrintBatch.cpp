@@ -0,0 +1,491 @@
+#include "PrintBatch.hpp"
+#include "base/Terminal.hpp"
+#include <cstring>
+#include <cstdio>
+
+namespace emb {
+    namespace console {
+        using namespace std;
+
+        namespace {
+            /// Sequential reader of the operands stored after each opcode
+            class Reader {
+            public:
+                Reader(char const* a_pData) noexcept : m_pData{ a_pData } {}
+
+                char const* position() const noexcept { return m_pData; }
+                template<typename T>
+                T byte() noexcept { return static_cast<T>(*m_pData++); }
+                unsigned int uint() noexcept {
+                    uint32_t uiValue{ 0 };
+                    memcpy(&uiValue, m_pData, sizeof(uiValue));
+                    m_pData += sizeof(uiValue);
+                    return uiValue;
+                }
+                void raw(void* a_pValue, size_t a_ulSize) noexcept {
+                    memcpy(a_pValue, m_pData, a_ulSize);
+                    m_pData += a_ulSize;
+                }
+                void skip(size_t a_ulSize) noexcept { m_pData += a_ulSize; }
+                /// Gives the text without copying it: it stays valid as long as the batch
+                char const* text(size_t& a_rulSize) noexcept {
+                    a_rulSize = uint();
+                    char const* pText{ m_pData };
+                    m_pData += a_rulSize;
+                    return pText;
+                }
+                void text(string& a_rstrText) noexcept {
+                    size_t const ulSize{ uint() };
+                    a_rstrText.assign(m_pData, ulSize);
+                    m_pData += ulSize;
+                }
+            private:
+                char const* m_pData{ nullptr };
+            };
+
+            /// Decodes a deferred format and builds its text
+            void readFormat(Reader& a_rReader, string& a_rstrText) noexcept {
+                // The arguments are decoded in place: their texts point into the batch
+                static thread_local vector<FormatArg> s_vArgs{};
+                s_vArgs.clear();
+                size_t ulFormatSize{ 0 };
+                char const* const pFormat{ a_rReader.text(ulFormatSize) };
+                for (unsigned int i = 0, uiN = a_rReader.uint(); i < uiN; ++i) {
+                    s_vArgs.emplace_back(false);
+                    FormatArg& rArg = s_vArgs.back();
+                    rArg.eType = a_rReader.byte<FormatArg::Type>();
+                    if (FormatArg::Type::Text == rArg.eType) {
+                        rArg.value.szText = a_rReader.text(rArg.ulSize);
+                    }
+                    else {
+                        a_rReader.raw(&rArg.value, sizeof(rArg.value));
+                    }
+                }
+                formatText(a_rstrText, pFormat, ulFormatSize, s_vArgs.data(), s_vArgs.size());
+            }
+
+            /// Skips a deferred format whose text has already been built
+            void skipFormat(Reader& a_rReader) noexcept {
+                a_rReader.skip(a_rReader.uint());
+                for (unsigned int i = 0, uiN = a_rReader.uint(); i < uiN; ++i) {
+                    if (FormatArg::Type::Text == a_rReader.byte<FormatArg::Type>()) {
+                        a_rReader.skip(a_rReader.uint());
+                    }
+                    else {
+                        a_rReader.skip(sizeof(FormatArg::Value));
+                    }
+                }
+            }
+
+            /// Gives the text of the next deferred format: built by the first replay of the batch, then reused
+            string const& nextFormat(Reader& a_rReader, FormattedTexts* a_pTexts, size_t& a_rulIndex, string& a_rstrText) noexcept {
+                if (!a_pTexts) {
+                    readFormat(a_rReader, a_rstrText);
+                    return a_rstrText;
+                }
+                if (string const* pstrText = a_pTexts->find(a_rulIndex++)) {
+                    skipFormat(a_rReader);
+                    return *pstrText;
+                }
+                string& rstrText = a_pTexts->add();
+                readFormat(a_rReader, rstrText);
+                return rstrText;
+            }
+        }
+
+        //////////////////////////////////////////////////
+        ///// Deferred formatting
+        //////////////////////////////////////////////////
+
+        void formatText(string& a_rstrText, char const* a_pFormat, size_t a_ulFormatSize, FormatArg const* a_pArgs, size_t a_ulNbArgs) noexcept {
+            a_rstrText.clear();
+            size_t ulArg{ 0 };
+            char szValue[32]{};
+            for (size_t i = 0; i < a_ulFormatSize; ++i) {
+                char const c{ a_pFormat[i] };
+                bool const bHasNext{ i + 1 < a_ulFormatSize };
+                if (('{' == c || '}' == c) && bHasNext && c == a_pFormat[i + 1]) {
+                    a_rstrText += c;
+                    ++i;
+                }
+                else if ('{' == c && bHasNext && '}' == a_pFormat[i + 1] && ulArg < a_ulNbArgs) {
+                    FormatArg const& arg = a_pArgs[ulArg++];
+                    switch (arg.eType) {
+                    case FormatArg::Type::Int:
+                        a_rstrText.append(szValue, snprintf(szValue, sizeof(szValue), "%lld", arg.value.llInt));
+                        break;
+                    case FormatArg::Type::UInt:
+                        a_rstrText.append(szValue, snprintf(szValue, sizeof(szValue), "%llu", arg.value.ullUInt));
+                        break;
+                    case FormatArg::Type::Double:
+                        a_rstrText.append(szValue, snprintf(szValue, sizeof(szValue), "%g", arg.value.dDouble));
+                        break;
+                    case FormatArg::Type::Bool:
+                        a_rstrText += arg.value.ullUInt ? "true" : "false";
+                        break;
+                    case FormatArg::Type::Char:
+                        a_rstrText += static_cast<char>(arg.value.ullUInt);
+                        break;
+                    case FormatArg::Type::Text:
+                        a_rstrText.append(arg.value.szText, arg.ulSize);
+                        break;
+                    case FormatArg::Type::Pointer:
+                        a_rstrText.append(szValue, snprintf(szValue, sizeof(szValue), "%p", arg.value.pPointer));
+                        break;
+                    }
+                    ++i;
+                }
+                else {
+                    a_rstrText += c;
+                }
+            }
+        }
+
+        //////////////////////////////////////////////////
+        ///// SharedPrintBatch
+        //////////////////////////////////////////////////
+
+        emb::tools::BoundedQueue<SharedPrintBatch::Data*>& SharedPrintBatch::pool() noexcept {
+            // Never destroyed: batches may still be released by terminals destroyed during the static deinitialization
+            static auto* s_pPool = new emb::tools::BoundedQueue<Data*>{ 1024 };
+            return *s_pPool;
+        }
+
+        SharedPrintBatch SharedPrintBatch::create(PrintBatch& a_rPrintBatch) noexcept {
+            Data* pData{ nullptr };
+            if (!pool().tryPop(pData)) {
+                pData = new Data{};
+            }
+            pData->uiRefs.store(1, std::memory_order_relaxed);
+            pData->batch.swap(a_rPrintBatch);
+            SharedPrintBatch sharedBatch{};
+            sharedBatch.m_pData = pData;
+            return sharedBatch;
+        }
+
+        void SharedPrintBatch::release() noexcept {
+            if (m_pData && 1 == m_pData->uiRefs.fetch_sub(1, std::memory_order_acq_rel)) {
+                m_pData->batch.clear();
+                m_pData->ulRenderings = 0;
+                m_pData->formattedTexts.clear();
+                if (!pool().tryPush(m_pData)) {
+                    delete m_pData;
+                }
+            }
+            m_pData = nullptr;
+        }
+
+        string const* SharedPrintBatch::findRendering(unsigned int const a_uiRenderClass) const noexcept {
+            for (size_t i = 0; i < m_pData->ulRenderings; ++i) {
+                if (a_uiRenderClass == m_pData->vRenderings[i].uiRenderClass) {
+                    return &m_pData->vRenderings[i].strBytes;
+                }
+            }
+            return nullptr;
+        }
+
+        string& SharedPrintBatch::addRendering(unsigned int const a_uiRenderClass) const noexcept {
+            if (m_pData->ulRenderings == m_pData->vRenderings.size()) {
+                m_pData->vRenderings.emplace_back();
+            }
+            Rendering& rRendering = m_pData->vRenderings[m_pData->ulRenderings++];
+            rRendering.uiRenderClass = a_uiRenderClass;
+            rRendering.strBytes.clear();
+            return rRendering.strBytes;
+        }
+
+        //////////////////////////////////////////////////
+        ///// PrintBatch
+        //////////////////////////////////////////////////
+
+        void PrintBatch::printFormat(char const* a_szFormat, FormatArg const* a_pArgs, size_t a_ulNbArgs) {
+            pushOpCode(OpCode::PrintFormat);
+            pushText(a_szFormat, a_szFormat ? strlen(a_szFormat) : 0);
+            pushUInt(static_cast<uint32_t>(a_ulNbArgs));
+            for (size_t i = 0; i < a_ulNbArgs; ++i) {
+                FormatArg const& arg = a_pArgs[i];
+                pushByte(arg.eType);
+                if (FormatArg::Type::Text == arg.eType) {
+                    pushText(arg.value.szText, arg.ulSize);
+                }
+                else {
+                    pushRaw(&arg.value, sizeof(arg.value));
+                }
+            }
+        }
+
+        void PrintBatch::replay(Terminal const& a_rTerminal, FormattedTexts* a_pTexts) const noexcept {
+            // The text buffer is reused from a command to another to avoid one allocation per text
+            string strText{};
+            string strLine{};
+            size_t ulFormat{ 0 };
+            Reader reader{ m_vData.data() };
+            char const* const pEnd{ m_vData.data() + m_vData.size() };
+            while (reader.position() < pEnd) {
+                switch (reader.byte<OpCode>()) {
+                case OpCode::Begin:
+                    a_rTerminal.begin();
+                    break;
+                case OpCode::Commit:
+                    a_rTerminal.commit();
+                    break;
+                case OpCode::MoveCursorUp:
+                    a_rTerminal.moveCursorUp(reader.uint());
+                    break;
+                case OpCode::MoveCursorDown:
+                    a_rTerminal.moveCursorDown(reader.uint());
+                    break;
+                case OpCode::MoveCursorForward:
+                    a_rTerminal.moveCursorForward(reader.uint());
+                    break;
+                case OpCode::MoveCursorBackward:
+                    a_rTerminal.moveCursorBackward(reader.uint());
+                    break;
+                case OpCode::MoveCursorToNextLine:
+                    a_rTerminal.moveCursorToNextLine(reader.uint());
+                    break;
+                case OpCode::MoveCursorToPreviousLine:
+                    a_rTerminal.moveCursorToPreviousLine(reader.uint());
+                    break;
+                case OpCode::MoveCursorToRow:
+                    a_rTerminal.moveCursorToRow(reader.uint());
+                    break;
+                case OpCode::MoveCursorToColumn:
+                    a_rTerminal.moveCursorToColumn(reader.uint());
+                    break;
+                case OpCode::MoveCursorToPosition: {
+                    unsigned int const uiR{ reader.uint() };
+                    unsigned int const uiC{ reader.uint() };
+                    a_rTerminal.moveCursorToPosition(uiR, uiC);
+                    break;
+                }
+                case OpCode::SaveCursor:
+                    a_rTerminal.saveCursor();
+                    break;
+                case OpCode::RestoreCursor:
+                    a_rTerminal.restoreCursor();
+                    break;
+                case OpCode::SetCursorBlinking:
+                    a_rTerminal.setCursorBlinking(reader.byte<bool>());
+                    break;
+                case OpCode::SetCursorVisible:
+                    a_rTerminal.setCursorVisible(reader.byte<bool>());
+                    break;
+                case OpCode::SetCursorShape:
+                    a_rTerminal.setCursorShape(reader.byte<SetCursorShape::Shape>());
+                    break;
+                case OpCode::ScrollUp:
+                    a_rTerminal.scrollUp(reader.uint());
+                    break;
+                case OpCode::ScrollDown:
+                    a_rTerminal.scrollDown(reader.uint());
+                    break;
+                case OpCode::InsertCharacter:
+                    a_rTerminal.insertCharacter(reader.uint());
+                    break;
+                case OpCode::DeleteCharacter:
+                    a_rTerminal.deleteCharacter(reader.uint());
+                    break;
+                case OpCode::EraseCharacter:
+                    a_rTerminal.eraseCharacter(reader.uint());
+                    break;
+                case OpCode::InsertLine:
+                    a_rTerminal.insertLine(reader.uint());
+                    break;
+                case OpCode::DeleteLine:
+                    a_rTerminal.deleteLine(reader.uint());
+                    break;
+                case OpCode::ClearDisplay:
+                    a_rTerminal.clearDisplay(reader.byte<ClearDisplay::Type>());
+                    break;
+                case OpCode::ClearLine:
+                    a_rTerminal.clearLine(reader.byte<ClearLine::Type>());
+                    break;
+                case OpCode::ResetTextFormat:
+                    a_rTerminal.resetTextFormat();
+                    break;
+                case OpCode::SetColor: {
+                    SetColor::Color const eFgColor{ reader.byte<SetColor::Color>() };
+                    SetColor::Color const eBgColor{ reader.byte<SetColor::Color>() };
+                    a_rTerminal.setColor(eFgColor, eBgColor);
+                    break;
+                }
+                case OpCode::SetNegativeColors:
+                    a_rTerminal.setNegativeColors(reader.byte<bool>());
+                    break;
+                case OpCode::SetBold:
+                    a_rTerminal.setBold(reader.byte<bool>());
+                    break;
+                case OpCode::SetItalic:
+                    a_rTerminal.setItalic(reader.byte<bool>());
+                    break;
+                case OpCode::SetUnderline:
+                    a_rTerminal.setUnderline(reader.byte<bool>());
+                    break;
+                case OpCode::SetHorizontalTab:
+                    a_rTerminal.setHorizontalTab();
+                    break;
+                case OpCode::HorizontalTabForward:
+                    a_rTerminal.goToHorizontalTabForward(reader.uint());
+                    break;
+                case OpCode::HorizontalTabBackward:
+                    a_rTerminal.goToHorizontalTabBackward(reader.uint());
+                    break;
+                case OpCode::ClearHorizontalTab:
+                    a_rTerminal.clearHorizontalTab(reader.byte<ClearHorizontalTab::Type>());
+                    break;
+                case OpCode::SetDecCharacterSet:
+                    a_rTerminal.setDecCharacterSet(reader.byte<bool>());
+                    break;
+                case OpCode::PrintSymbol: {
+                    PrintSymbol::Symbol const eSymbol{ reader.byte<PrintSymbol::Symbol>() };
+                    a_rTerminal.printSymbol(eSymbol, reader.uint());
+                    break;
+                }
+                case OpCode::SetScrollingRegion: {
+                    unsigned int const uiT{ reader.uint() };
+                    unsigned int const uiB{ reader.uint() };
+                    a_rTerminal.setScrollingRegion(uiT, uiB);
+                    break;
+                }
+                case OpCode::SetWindowTitle:
+                    reader.text(strText);
+                    a_rTerminal.setWindowTitle(strText);
+                    break;
+                case OpCode::UseAlternateScreenBuffer:
+                    a_rTerminal.useAlternateScreenBuffer(reader.byte<bool>());
+                    break;
+                case OpCode::RingBell:
+                    a_rTerminal.ringBell();
+                    break;
+                case OpCode::PrintNewLine:
+                    for (unsigned int i = 0, uiN = reader.uint(); i < uiN; ++i) {
+                        a_rTerminal.printNewLine();
+                    }
+                    break;
+                case OpCode::PrintText:
+                    reader.text(strText);
+                    a_rTerminal.printText(strText);
+                    break;
+                case OpCode::PrintTextAt: {
+                    unsigned int const uiR{ reader.uint() };
+                    unsigned int const uiC{ reader.uint() };
+                    reader.text(strText);
+                    a_rTerminal.printTextAt(strText, uiR, uiC);
+                    break;
+                }
+                case OpCode::PrintFormat: {
+                    string const& rstrFormatted = nextFormat(reader, a_pTexts, ulFormat, strText);
+                    // Printed line by line, as print(std::string const&) does
+                    for (size_t ulBegin = 0; ulBegin < rstrFormatted.size();) {
+                        size_t ulEnd{ rstrFormatted.find('\n', ulBegin) };
+                        if (string::npos == ulEnd) {
+                            ulEnd = rstrFormatted.size();
+                        }
+                        strLine.assign(rstrFormatted, ulBegin, ulEnd - ulBegin);
+                        a_rTerminal.printText(strLine);
+                        a_rTerminal.printNewLine();
+                        ulBegin = ulEnd + 1;
+                    }
+                    break;
+                }
+                }
+            }
+        }
+
+        void PrintBatch::appendText(string& a_rstrText, FormattedTexts* a_pTexts) const noexcept {
+            string strText{};
+            size_t ulFormat{ 0 };
+            Reader reader{ m_vData.data() };
+            char const* const pEnd{ m_vData.data() + m_vData.size() };
+            while (reader.position() < pEnd) {
+                switch (reader.byte<OpCode>()) {
+                case OpCode::Begin:
+                case OpCode::Commit:
+                case OpCode::SaveCursor:
+                case OpCode::RestoreCursor:
+                case OpCode::ResetTextFormat:
+                case OpCode::SetHorizontalTab:
+                case OpCode::RingBell:
+                    break;
+                case OpCode::SetCursorBlinking:
+                case OpCode::SetCursorVisible:
+                case OpCode::SetCursorShape:
+                case OpCode::ClearDisplay:
+                case OpCode::ClearLine:
+                case OpCode::SetNegativeColors:
+                case OpCode::SetBold:
+                case OpCode::SetItalic:
+                case OpCode::SetUnderline:
+                case OpCode::ClearHorizontalTab:
+                case OpCode::SetDecCharacterSet:
+                case OpCode::UseAlternateScreenBuffer:
+                    reader.byte<char>();
+                    break;
+                case OpCode::SetColor:
+                    reader.byte<char>();
+                    reader.byte<char>();
+                    break;
+                case OpCode::MoveCursorUp:
+                case OpCode::MoveCursorDown:
+                case OpCode::MoveCursorForward:
+                case OpCode::MoveCursorBackward:
+                case OpCode::MoveCursorToNextLine:
+                case OpCode::MoveCursorToPreviousLine:
+                case OpCode::MoveCursorToRow:
+                case OpCode::MoveCursorToColumn:
+                case OpCode::ScrollUp:
+                case OpCode::ScrollDown:
+                case OpCode::InsertCharacter:
+                case OpCode::DeleteCharacter:
+                case OpCode::EraseCharacter:
+                case OpCode::InsertLine:
+                case OpCode::DeleteLine:
+                case OpCode::HorizontalTabForward:
+                case OpCode::HorizontalTabBackward:
+                    reader.uint();
+                    break;
+                case OpCode::MoveCursorToPosition:
+                case OpCode::SetScrollingRegion:
+                    reader.uint();
+                    reader.uint();
+                    break;
+                case OpCode::SetWindowTitle:
+                    reader.text(strText);
+                    break;
+                case OpCode::PrintSymbol: {
+                    // Only the spaces are text, the other symbols draw lines
+                    PrintSymbol::Symbol const eSymbol{ reader.byte<PrintSymbol::Symbol>() };
+                    unsigned int const uiN{ reader.uint() };
+                    if (PrintSymbol::Symbol::Space == eSymbol) {
+                        a_rstrText.append(uiN, ' ');
+                    }
+                    break;
+                }
+                case OpCode::PrintNewLine:
+                    a_rstrText.append(reader.uint(), '\n');
+                    break;
+                case OpCode::PrintText:
+                    reader.text(strText);
+                    a_rstrText += strText;
+                    break;
+                case OpCode::PrintTextAt:
+                    reader.uint();
+                    reader.uint();
+                    reader.text(strText);
+                    a_rstrText += strText;
+                    break;
+                case OpCode::PrintFormat: {
+                    string const& rstrFormatted = nextFormat(reader, a_pTexts, ulFormat, strText);
+                    a_rstrText += rstrFormatted;
+                    if (!rstrFormatted.empty() && '\n' != rstrFormatted.back()) {
+                        // Printed line by line by replay(), each line ending with a new line
+                        a_rstrText += '\n';
+                    }
+                    break;
+                }
+                }
+            }
+        }
+    } // console
+} // emb
@@ -0,0 +1,297 @@
+#pragma once
+
+#include "EmbConsole.hpp"
+#include "BoundedQueue.hpp"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+namespace emb {
+    namespace console {
+        /**
+         * @brief Texts of the deferred formats of a batch, in the order of the formats.
+         *        Cleared texts keep their memory for the next batch.
+         */
+        class FormattedTexts {
+        public:
+            /// Gives the text of a format, nullptr if it has not been built yet
+            std::string const* find(size_t a_ulIndex) const noexcept { return a_ulIndex < m_ulSize ? &m_vTexts[a_ulIndex] : nullptr; }
+            /// Adds the text of the next format, to be filled by the caller
+            std::string& add() noexcept {
+                if (m_ulSize == m_vTexts.size()) {
+                    m_vTexts.emplace_back();
+                }
+                return m_vTexts[m_ulSize++];
+            }
+            void clear() noexcept { m_ulSize = 0; }
+
+        private:
+            std::vector<std::string> m_vTexts{};    ///< Only the first m_ulSize are valid, the others keep their memory
+            size_t m_ulSize{ 0 };
+        };
+
+        /**
+         * @brief Compact, value-typed list of print commands.
+         *        Each command is stored as an opcode followed by its inline operands (and its text, if any) in a single
+         *        contiguous buffer. Once the buffer has grown to its working size, encoding and replaying commands do not
+         *        allocate anymore.
+         */
+        class PrintBatch {
+        public:
+            enum class OpCode : std::uint8_t {
+                Begin,
+                Commit,
+                MoveCursorUp,
+                MoveCursorDown,
+                MoveCursorForward,
+                MoveCursorBackward,
+                MoveCursorToNextLine,
+                MoveCursorToPreviousLine,
+                MoveCursorToRow,
+                MoveCursorToColumn,
+                MoveCursorToPosition,
+                SaveCursor,
+                RestoreCursor,
+                SetCursorBlinking,
+                SetCursorVisible,
+                SetCursorShape,
+                ScrollUp,
+                ScrollDown,
+                InsertCharacter,
+                DeleteCharacter,
+                EraseCharacter,
+                InsertLine,
+                DeleteLine,
+                ClearDisplay,
+                ClearLine,
+                ResetTextFormat,
+                SetColor,
+                SetNegativeColors,
+                SetBold,
+                SetItalic,
+                SetUnderline,
+                SetHorizontalTab,
+                HorizontalTabForward,
+                HorizontalTabBackward,
+                ClearHorizontalTab,
+                SetDecCharacterSet,
+                PrintSymbol,
+                SetScrollingRegion,
+                SetWindowTitle,
+                UseAlternateScreenBuffer,
+                RingBell,
+                PrintNewLine,
+                PrintText,
+                PrintTextAt,
+                PrintFormat
+            };
+
+        public:
+            PrintBatch() noexcept = default;
+            PrintBatch(PrintBatch const&) = default;
+            PrintBatch(PrintBatch&&) noexcept = default;
+            ~PrintBatch() noexcept = default;
+            PrintBatch& operator= (PrintBatch const&) = default;
+            PrintBatch& operator= (PrintBatch&&) noexcept = default;
+
+            bool empty() const noexcept { return m_vData.empty(); }
+            size_t size() const noexcept { return m_vData.size(); }
+            /// Removes all the commands but keeps the allocated memory for the next use
+            void clear() noexcept { m_vData.clear(); }
+            void reserve(size_t a_ulSize) { m_vData.reserve(a_ulSize); }
+            void swap(PrintBatch& a_rOther) noexcept { m_vData.swap(a_rOther.m_vData); }
+            /// Appends all the commands of another batch at the end of this one
+            void append(PrintBatch const& a_Other) { m_vData.insert(m_vData.end(), a_Other.m_vData.begin(), a_Other.m_vData.end()); }
+
+            /**
+             * @brief Executes all the commands of the batch on a terminal, in the order they were encoded
+             * @param a_rTerminal   Terminal on which the commands are executed
+             * @param a_pTexts      Texts of the deferred formats, built by the first replay and reused by the next ones.
+             *                      nullptr to format them again.
+             */
+            void replay(Terminal const& a_rTerminal, FormattedTexts* a_pTexts = nullptr) const noexcept;
+            /**
+             * @brief Appends the text printed by the batch, without colors nor cursor moves (e.g. to capture an output)
+             * @param a_rstrText    Receives the text
+             * @param a_pTexts      Texts of the deferred formats, shared with replay(). nullptr to format them again.
+             */
+            void appendText(std::string& a_rstrText, FormattedTexts* a_pTexts = nullptr) const noexcept;
+
+            void begin() { pushOpCode(OpCode::Begin); }
+            void commit() { pushOpCode(OpCode::Commit); }
+            void moveCursorUp(unsigned int const a_uiN) { pushOpCode(OpCode::MoveCursorUp); pushUInt(a_uiN); }
+            void moveCursorDown(unsigned int const a_uiN) { pushOpCode(OpCode::MoveCursorDown); pushUInt(a_uiN); }
+            void moveCursorForward(unsigned int const a_uiN) { pushOpCode(OpCode::MoveCursorForward); pushUInt(a_uiN); }
+            void moveCursorBackward(unsigned int const a_uiN) { pushOpCode(OpCode::MoveCursorBackward); pushUInt(a_uiN); }
+            void moveCursorToNextLine(unsigned int const a_uiN) { pushOpCode(OpCode::MoveCursorToNextLine); pushUInt(a_uiN); }
+            void moveCursorToPreviousLine(unsigned int const a_uiN) { pushOpCode(OpCode::MoveCursorToPreviousLine); pushUInt(a_uiN); }
+            void moveCursorToRow(unsigned int const a_uiR) { pushOpCode(OpCode::MoveCursorToRow); pushUInt(a_uiR); }
+            void moveCursorToColumn(unsigned int const a_uiC) { pushOpCode(OpCode::MoveCursorToColumn); pushUInt(a_uiC); }
+            void moveCursorToPosition(unsigned int const a_uiR, unsigned int const a_uiC) { pushOpCode(OpCode::MoveCursorToPosition); pushUInt(a_uiR); pushUInt(a_uiC); }
+            void saveCursor() { pushOpCode(OpCode::SaveCursor); }
+            void restoreCursor() { pushOpCode(OpCode::RestoreCursor); }
+            void setCursorBlinking(bool const a_bBlinking) { pushOpCode(OpCode::SetCursorBlinking); pushByte(a_bBlinking); }
+            void setCursorVisible(bool const a_bVisible) { pushOpCode(OpCode::SetCursorVisible); pushByte(a_bVisible); }
+            void setCursorShape(SetCursorShape::Shape const a_eShape) { pushOpCode(OpCode::SetCursorShape); pushByte(a_eShape); }
+            void scrollUp(unsigned int const a_uiN) { pushOpCode(OpCode::ScrollUp); pushUInt(a_uiN); }
+            void scrollDown(unsigned int const a_uiN) { pushOpCode(OpCode::ScrollDown); pushUInt(a_uiN); }
+            void insertCharacter(unsigned int const a_uiN) { pushOpCode(OpCode::InsertCharacter); pushUInt(a_uiN); }
+            void deleteCharacter(unsigned int const a_uiN) { pushOpCode(OpCode::DeleteCharacter); pushUInt(a_uiN); }
+            void eraseCharacter(unsigned int const a_uiN) { pushOpCode(OpCode::EraseCharacter); pushUInt(a_uiN); }
+            void insertLine(unsigned int const a_uiN) { pushOpCode(OpCode::InsertLine); pushUInt(a_uiN); }
+            void deleteLine(unsigned int const a_uiN) { pushOpCode(OpCode::DeleteLine); pushUInt(a_uiN); }
+            void clearDisplay(ClearDisplay::Type const a_eType) { pushOpCode(OpCode::ClearDisplay); pushByte(a_eType); }
+            void clearLine(ClearLine::Type const a_eType) { pushOpCode(OpCode::ClearLine); pushByte(a_eType); }
+            void resetTextFormat() { pushOpCode(OpCode::ResetTextFormat); }
+            void setColor(SetColor::Color const a_eFgColor, SetColor::Color const a_eBgColor) { pushOpCode(OpCode::SetColor); pushByte(a_eFgColor); pushByte(a_eBgColor); }
+            void setNegativeColors(bool const a_bEnabled) { pushOpCode(OpCode::SetNegativeColors); pushByte(a_bEnabled); }
+            void setBold(bool const a_bEnabled) { pushOpCode(OpCode::SetBold); pushByte(a_bEnabled); }
+            void setItalic(bool const a_bEnabled) { pushOpCode(OpCode::SetItalic); pushByte(a_bEnabled); }
+            void setUnderline(bool const a_bEnabled) { pushOpCode(OpCode::SetUnderline); pushByte(a_bEnabled); }
+            void setHorizontalTab() { pushOpCode(OpCode::SetHorizontalTab); }
+            void goToHorizontalTabForward(unsigned int const a_uiN) { pushOpCode(OpCode::HorizontalTabForward); pushUInt(a_uiN); }
+            void goToHorizontalTabBackward(unsigned int const a_uiN) { pushOpCode(OpCode::HorizontalTabBackward); pushUInt(a_uiN); }
+            void clearHorizontalTab(ClearHorizontalTab::Type const a_eType) { pushOpCode(OpCode::ClearHorizontalTab); pushByte(a_eType); }
+            void setDecCharacterSet(bool const a_bEnabled) { pushOpCode(OpCode::SetDecCharacterSet); pushByte(a_bEnabled); }
+            void printSymbol(PrintSymbol::Symbol const a_eSymbol, unsigned int const a_uiN) { pushOpCode(OpCode::PrintSymbol); pushByte(a_eSymbol); pushUInt(a_uiN); }
+            void setScrollingRegion(unsigned int const a_uiT, unsigned int const a_uiB) { pushOpCode(OpCode::SetScrollingRegion); pushUInt(a_uiT); pushUInt(a_uiB); }
+            void setWindowTitle(std::string const& a_strTitle) { pushOpCode(OpCode::SetWindowTitle); pushText(a_strTitle.data(), a_strTitle.size()); }
+            void useAlternateScreenBuffer(bool const a_bEnabled) { pushOpCode(OpCode::UseAlternateScreenBuffer); pushByte(a_bEnabled); }
+            void ringBell() { pushOpCode(OpCode::RingBell); }
+            void printNewLine(unsigned int const a_uiN) { pushOpCode(OpCode::PrintNewLine); pushUInt(a_uiN); }
+            void printText(char const* a_szText, size_t a_ulSize) { pushOpCode(OpCode::PrintText); pushText(a_szText, a_ulSize); }
+            void printText(std::string const& a_strText) { printText(a_strText.data(), a_strText.size()); }
+            void printTextAt(std::string const& a_strText, unsigned int const a_uiR, unsigned int const a_uiC) {
+                pushOpCode(OpCode::PrintTextAt); pushUInt(a_uiR); pushUInt(a_uiC); pushText(a_strText.data(), a_strText.size());
+            }
+            /**
+             * @brief Encodes a deferred format: the format and the raw arguments are copied, the text is built by replay()
+             */
+            void printFormat(char const* a_szFormat, FormatArg const* a_pArgs, size_t a_ulNbArgs);
+
+        private:
+            void pushOpCode(OpCode const a_eOpCode) { m_vData.push_back(static_cast<char>(a_eOpCode)); }
+            template<typename T>
+            void pushByte(T const a_Value) { m_vData.push_back(static_cast<char>(a_Value)); }
+            void pushRaw(void const* a_pValue, size_t a_ulSize) {
+                char const* pValue = static_cast<char const*>(a_pValue);
+                m_vData.insert(m_vData.end(), pValue, pValue + a_ulSize);
+            }
+            void pushUInt(std::uint32_t const a_uiValue) {
+                char const* pValue = reinterpret_cast<char const*>(&a_uiValue);
+                m_vData.insert(m_vData.end(), pValue, pValue + sizeof(a_uiValue));
+            }
+            void pushText(char const* a_szText, size_t a_ulSize) {
+                pushUInt(static_cast<std::uint32_t>(a_ulSize));
+                m_vData.insert(m_vData.end(), a_szText, a_szText + a_ulSize);
+            }
+
+        private:
+            std::vector<char> m_vData{};
+        };
+
+        /**
+         * @brief Formats text: each "{}" of the format is replaced by the next argument, "{{" and "}}" give braces.
+         *        A "{}" without a matching argument is kept as is.
+         * @param a_rstrText    Receives the text, cleared first
+         * @param a_pFormat     Format, not necessarily null-terminated
+         * @param a_ulFormatSize    Size of the format
+         * @param a_pArgs       Arguments
+         * @param a_ulNbArgs    Number of arguments
+         */
+        void formatText(std::string& a_rstrText, char const* a_pFormat, size_t a_ulFormatSize, FormatArg const* a_pArgs, size_t a_ulNbArgs) noexcept;
+
+        /**
+         * @brief Prints text built from a format and arguments, formatted by the console thread (see IPrintableConsole::print()).
+         *        The command references the format and the arguments of the caller, its copies own them.
+         */
+        class PrintFormat final
+            : public PrintCommand {
+        public:
+            PrintFormat(char const* a_szFormat, FormatArg const* a_pArgs, size_t a_ulNbArgs) noexcept : m_szFormat{ a_szFormat }, m_pArgs{ a_pArgs }, m_ulNbArgs{ a_ulNbArgs } { }
+            PrintFormat(PrintFormat const& a_Other);
+            PrintFormat& operator= (PrintFormat const&) = delete;
+            Ptr copy() const noexcept override;
+            void encode(PrintBatch&) const noexcept override;
+        private:
+            std::string m_strFormat{};          ///< Format owned by a copy
+            std::string m_strTexts{};           ///< Texts of the arguments owned by a copy
+            std::vector<FormatArg> m_vArgs{};   ///< Arguments owned by a copy, their texts point into m_strTexts
+            char const* m_szFormat{ nullptr };
+            FormatArg const* m_pArgs{ nullptr };
+            size_t m_ulNbArgs{ 0 };
+        };
+
+        /**
+         * @brief Committed print batch, immutable and reference-counted, so that a single batch can be referenced by all the
+         *        terminals it is printed on. Released batches are kept in a pool and reused by the next commits.
+         */
+        class SharedPrintBatch {
+        public:
+            SharedPrintBatch() noexcept = default;
+            SharedPrintBatch(SharedPrintBatch const& a_Other) noexcept : m_pData{ a_Other.m_pData } {
+                if (m_pData) {
+                    m_pData->uiRefs.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            SharedPrintBatch(SharedPrintBatch&& a_Other) noexcept : m_pData{ a_Other.m_pData } { a_Other.m_pData = nullptr; }
+            ~SharedPrintBatch() noexcept { release(); }
+            SharedPrintBatch& operator= (SharedPrintBatch a_Other) noexcept { swap(*this, a_Other); return *this; }
+
+            /**
+             * @brief Publishes the content of a batch
+             * @param a_rPrintBatch Batch to publish. It receives an empty batch whose memory can be reused.
+             * @return SharedPrintBatch The published batch
+             */
+            static SharedPrintBatch create(PrintBatch& a_rPrintBatch) noexcept;
+
+            explicit operator bool() const noexcept { return nullptr != m_pData; }
+            PrintBatch const& operator*() const noexcept { return m_pData->batch; }
+            PrintBatch const* operator->() const noexcept { return &m_pData->batch; }
+
+            friend void swap(SharedPrintBatch& a_rFirst, SharedPrintBatch& a_rSecond) noexcept { std::swap(a_rFirst.m_pData, a_rSecond.m_pData); }
+
+            /**
+             * @brief Gives the bytes the batch has been rendered into for a class of terminals.
+             *        The renderings are only accessed by the console thread, which processes all the terminals the batch is
+             *        shared by.
+             * @param a_uiRenderClass   Class of the terminals, see TerminalAnsi::getRenderClass()
+             * @return std::string const*   The rendered bytes, nullptr if the batch has not been rendered for the class yet
+             */
+            std::string const* findRendering(unsigned int const a_uiRenderClass) const noexcept;
+            /**
+             * @brief Adds an empty rendering for a class of terminals, to be filled by the caller
+             * @param a_uiRenderClass   Class of the terminals
+             * @return std::string&     The bytes of the rendering, reused from a previous use of the batch memory
+             */
+            std::string& addRendering(unsigned int const a_uiRenderClass) const noexcept;
+            /**
+             * @brief Gives the texts of the deferred formats of the batch, so that each format is built once for all the
+             *        terminals. Like the renderings, they are only accessed by the console thread.
+             * @return FormattedTexts&  The texts, to be given to PrintBatch::replay()
+             */
+            FormattedTexts& formattedTexts() const noexcept { return m_pData->formattedTexts; }
+
+        private:
+            struct Rendering {
+                unsigned int uiRenderClass{ 0 };
+                std::string strBytes{};
+            };
+            struct Data {
+                std::atomic<unsigned int> uiRefs{ 0 };
+                PrintBatch batch{};
+                std::vector<Rendering> vRenderings{};   ///< Only the first ulRenderings are valid, the others keep their memory
+                size_t ulRenderings{ 0 };
+                FormattedTexts formattedTexts{};
+            };
+
+        private:
+            static emb::tools::BoundedQueue<Data*>& pool() noexcept;
+            void release() noexcept;
+
+        private:
+            Data* m_pData{ nullptr };
+        };
+    } // console
+} // emb
@@ -15,8 +15,11 @@
 #define eof _eof
 #else
 #include <unistd.h>
+#include <poll.h>
+#include <sys/ioctl.h>
 #endif
 #include <fcntl.h>
+#include <cerrno>
 #include <stdio.h>
 #include <mutex>
 #include <chrono>
@@ -32,6 +35,7 @@
 #endif
 
 StdCapture::StdCapture():
+    m_oldStdOut(-1),
     m_capturing(false)
 {
     // make stdout & stderr streams unbuffered
@@ -43,6 +47,16 @@ StdCapture::StdCapture():
     setvbuf(stderr,NULL,_IONBF,0);
 }
 
+StdCapture::~StdCapture()
+{
+#ifdef unix
+    // The reader thread must not outlive the object
+    EndCapture();
+#endif
+    if (m_oldStdOut >= 0)
+        secure_close(m_oldStdOut);
+}
+
 void StdCapture::BeginCapture()
 {
     std::lock_guard<std::mutex> lock(m_mutex);
@@ -50,14 +64,40 @@ void StdCapture::BeginCapture()
         return;
 
     secure_pipe(m_pipe);
-    m_oldStdOut = secure_dup(STD_OUT_FD);
+#ifdef unix
+    // A single pipe for the whole capture, enlarged so that bursts are absorbed while the reader is scheduled
+    m_pipeSize = 64 * 1024;
+#ifdef F_SETPIPE_SZ
+    int const pipeSize = fcntl(m_pipe[READ], F_SETPIPE_SZ, 1 << 20);
+    if (pipeSize > 0)
+        m_pipeSize = static_cast<size_t>(pipeSize);
+#endif
+    // Only the read end is non-blocking: the write end becomes the standard output of the application, whose streams
+    // would be left in error by a failed write. The reader drains the pipe continuously into the bounded backlog, where
+    // the bytes that cannot be delivered are dropped and counted.
+    fcntl(m_pipe[READ], F_SETFL, fcntl(m_pipe[READ], F_GETFL) | O_NONBLOCK);
+    fcntl(m_pipe[READ], F_SETFD, FD_CLOEXEC);
+    secure_pipe(m_stopPipe);
+#endif
+    // The copy of the real standard output is kept open between the captures: a descriptor given by GetStdOutFd() stays
+    // valid whenever it is used
+    if (m_oldStdOut < 0)
+        m_oldStdOut = secure_dup(STD_OUT_FD);
+    else
+        secure_dup2(STD_OUT_FD, m_oldStdOut);
     m_oldStdErr = secure_dup(STD_ERR_FD);
+    m_realStdOut = m_oldStdOut;
     secure_dup2(m_pipe[WRITE],STD_OUT_FD);
     secure_dup2(m_pipe[WRITE],STD_ERR_FD);
     m_capturing = true;
 #if !(defined _MSC_VER || defined __MINGW32__)
     secure_close(m_pipe[WRITE]);
 #endif
+#ifdef unix
+    m_readerDone = false;
+    m_reader = std::thread{ &StdCapture::readerLoop, this };
+    m_delivery = std::thread{ &StdCapture::deliveryLoop, this };
+#endif
 }
 bool StdCapture::IsCapturing()
 {
@@ -73,11 +113,22 @@ bool StdCapture::EndCapture()
     m_captured.clear();
     secure_dup2(m_oldStdOut, STD_OUT_FD);
     secure_dup2(m_oldStdErr, STD_ERR_FD);
+    m_realStdOut = -1;
 
     if(m_fctCaptureEnd) {
         m_fctCaptureEnd();
     }
 
+#ifdef unix
+    // The reader delivers what is left in the pipe before leaving
+    const char stop = 0;
+    ssize_t written = write(m_stopPipe[WRITE], &stop, sizeof(stop));
+    (void)written;
+    m_reader.join();
+    m_delivery.join();
+    secure_close(m_stopPipe[READ]);
+    secure_close(m_stopPipe[WRITE]);
+#else
     const int bufSize = 1025;
     char buf[bufSize];
     int bytesRead = 0;
@@ -105,8 +156,8 @@ bool StdCapture::EndCapture()
         }
     }
     while(fd_blocked || bytesRead == (bufSize-1));
+#endif
 
-    secure_close(m_oldStdOut);
     secure_close(m_oldStdErr);
     secure_close(m_pipe[READ]);
 #if defined _MSC_VER || defined __MINGW32__
@@ -126,10 +177,140 @@ std::string StdCapture::GetCapture()
     return m_captured;
 }
 
+int StdCapture::GetStdOutFd()
+{
+    // Without the lock: EndCapture() holds it while the delivery thread, which may wait for the console thread, ends
+    int const fd = m_realStdOut.load();
+    return fd >= 0 ? fd : STD_OUT_FD;
+}
+
+StdCapture::Stats StdCapture::GetStats()
+{
+    Stats stats{};
+    stats.capturedBytes = m_capturedBytes.load();
+    stats.droppedBytes = m_droppedBytes.load();
+    stats.pipeFull = m_pipeFull.load();
+    return stats;
+}
+
 void StdCapture::setCaptureEndEvt(std::function<void(void)> const& a_fctCaptureEnd) {
     m_fctCaptureEnd = a_fctCaptureEnd;
 }
 
+void StdCapture::setCaptureEvt(std::function<void(std::string const&)> const& a_fctCapture) {
+#ifdef unix
+    std::lock_guard<std::mutex> lock(m_captureEvtMutex);
+    m_fctCapture = a_fctCapture;
+#else
+    (void)a_fctCapture;
+#endif
+}
+
+#ifdef unix
+void StdCapture::readerLoop()
+{
+    // Only moves the data out of the pipe, so that the pipe stays as empty as possible whatever the delivery costs
+    char buf[16 * 1024];
+    bool stop = false;
+    while (!stop)
+    {
+        struct pollfd fds[2] = { { m_pipe[READ], POLLIN, 0 }, { m_stopPipe[READ], POLLIN, 0 } };
+        int ret = poll(fds, 2, -1);
+        if (ret < 0 && errno != EINTR)
+            stop = true;
+        if (ret > 0 && fds[1].revents != 0)
+            stop = true;
+
+        // The pipe is stored by pages, a full pipe may still show some room. A write to a full pipe waits for the reader.
+        int available = 0;
+        if (ioctl(m_pipe[READ], FIONREAD, &available) == 0 && static_cast<size_t>(available) + m_pipeSize / 16 >= m_pipeSize)
+            ++m_pipeFull;
+
+        ssize_t bytesRead = 0;
+        while ((bytesRead = read(m_pipe[READ], buf, sizeof(buf))) > 0)
+        {
+            size_t const size = static_cast<size_t>(bytesRead);
+            m_capturedBytes += size;
+            std::lock_guard<std::mutex> lock(m_backlogMutex);
+            if (m_backlog.size() + size <= s_maxBacklog)
+            {
+                m_backlog.append(buf, size);
+            }
+            else
+            {
+                m_backlogDropped += size;
+                m_droppedBytes += size;
+            }
+        }
+        // End of file: nobody writes to the pipe anymore
+        if (bytesRead == 0)
+            stop = true;
+        std::lock_guard<std::mutex> lock(m_backlogMutex);
+        m_readerDone = stop;
+        m_backlogCondition.notify_one();
+    }
+}
+
+void StdCapture::deliveryLoop()
+{
+    std::string pending;
+    std::string incoming;
+    bool done = false;
+    while (!done)
+    {
+        uint64_t dropped = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_backlogMutex);
+            // A partial line is delivered when nothing completes it shortly
+            auto const hasWork = [this] { return !m_backlog.empty() || m_backlogDropped > 0 || m_readerDone; };
+            if (pending.empty())
+                m_backlogCondition.wait(lock, hasWork);
+            else if (!m_backlogCondition.wait_for(lock, std::chrono::milliseconds(20), hasWork))
+            {
+                lock.unlock();
+                deliver(pending, true);
+                continue;
+            }
+            // Swapped rather than copied: the reader is never kept waiting for the lock
+            incoming.clear();
+            incoming.swap(m_backlog);
+            std::swap(dropped, m_backlogDropped);
+            done = m_readerDone;
+        }
+        pending += incoming;
+        if (dropped > 0)
+        {
+            deliver(pending, true);
+            std::string marker = "[" + std::to_string(dropped) + " bytes of captured output dropped]";
+            deliver(marker, true);
+        }
+        deliver(pending, done);
+    }
+}
+
+void StdCapture::deliver(std::string & text, bool partial)
+{
+    if (text.empty())
+        return;
+    size_t size = partial ? text.size() : text.rfind('\n');
+    if (size == std::string::npos)
+        return;
+    if (!partial)
+        ++size;
+    // Trailing blanks are removed, the same way GetCapture() does
+    size_t end = size;
+    while (end > 0 && std::isspace(static_cast<unsigned char>(text[end - 1])))
+        --end;
+    if (end > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_captureEvtMutex);
+        if (m_fctCapture)
+            m_fctCapture(text.substr(0, end));
+    }
+    text.erase(0, size);
+}
+#endif
+
 int StdCapture::secure_dup(int src)
 {
     int ret = -1;
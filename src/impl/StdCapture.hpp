@@ -5,28 +5,58 @@
 #include <string>
 #include <mutex>
 #include <functional>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 
 class StdCapture
 {
 public:
+    struct Stats
+    {
+        uint64_t capturedBytes;
+        uint64_t droppedBytes;
+        uint64_t pipeFull;
+    };
 
     StdCapture();
+    ~StdCapture();
 
     void BeginCapture();
     bool IsCapturing();
     bool EndCapture();
     std::string GetCapture();
 
+    /**
+     * @brief Gives the descriptor of the real standard output, to write to it without being captured.
+     *        Never waits for the capture to begin or end.
+     */
+    int GetStdOutFd();
+
+    Stats GetStats();
+
     void setCaptureEndEvt(std::function<void(void)> const& a_fctCaptureEnd);
+    /**
+     * @brief Sets the function receiving the captured text as soon as it is read, by complete lines when possible.
+     *        Only used by the persistent capture (unix), where GetCapture() gives nothing.
+     */
+    void setCaptureEvt(std::function<void(std::string const&)> const& a_fctCapture);
 
 private:
     enum PIPES { READ, WRITE };
-    
+
     int secure_dup(int src);
     void secure_pipe(int * pipes);
     void secure_dup2(int src, int dest);
     void secure_close(int & fd);
 
+#ifdef unix
+    void readerLoop();
+    void deliveryLoop();
+    void deliver(std::string & text, bool partial);
+#endif
+
     int m_pipe[2];
     int m_oldStdOut;
     int m_oldStdErr;
@@ -35,7 +65,26 @@ private:
     std::string m_captured;
 
     std::function<void(void)> m_fctCaptureEnd{};
+
+#ifdef unix
+    static const size_t s_maxBacklog = 4 * 1024 * 1024;    ///< Captured bytes waiting for delivery, beyond which they are dropped
+
+    int m_stopPipe[2]{ -1, -1 };  ///< Wakes the reader up when the capture ends
+    size_t m_pipeSize{ 0 };
+    std::thread m_reader{};
+    std::thread m_delivery{};
+    std::mutex m_backlogMutex{};
+    std::condition_variable m_backlogCondition{};
+    std::string m_backlog{};        ///< Read by the reader, waiting for the delivery thread
+    uint64_t m_backlogDropped{ 0 }; ///< Bytes dropped since the last delivery
+    bool m_readerDone{ false };
+    std::mutex m_captureEvtMutex{};
+    std::function<void(std::string const&)> m_fctCapture{};
+#endif
+    std::atomic<int> m_realStdOut{ -1 };   ///< Copy of the real standard output while capturing, -1 otherwise
+    std::atomic<uint64_t> m_capturedBytes{ 0 };
+    std::atomic<uint64_t> m_droppedBytes{ 0 };
+    std::atomic<uint64_t> m_pipeFull{ 0 };
 };
 
 #endif // STDCAPTURE_H
-
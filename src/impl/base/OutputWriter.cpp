@@ -0,0 +1,96 @@
+#include "OutputWriter.hpp"
+#include <cerrno>
+#include <algorithm>
+#ifdef unix
+#include <unistd.h>
+#include <poll.h>
+#include <limits.h>
+#else
+#include <stdio.h>
+#endif
+
+namespace emb {
+    namespace console {
+        using namespace std;
+
+        void OutputWriter::clear() noexcept {
+            m_strArena.clear();
+            m_vSegments.clear();
+        }
+
+        void OutputWriter::append(char const* a_pData, size_t a_ulSize) noexcept {
+            if (0 == a_ulSize) {
+                return;
+            }
+            // Consecutive copies are merged into a single segment
+            if (m_vSegments.empty() || nullptr != m_vSegments.back().pData) {
+                Segment segment{};
+                segment.ulOffset = m_strArena.size();
+                m_vSegments.push_back(segment);
+            }
+            m_strArena.append(a_pData, a_ulSize);
+            m_vSegments.back().ulSize += a_ulSize;
+        }
+
+        void OutputWriter::appendReference(char const* a_pData, size_t a_ulSize) noexcept {
+            if (0 == a_ulSize) {
+                return;
+            }
+            Segment segment{};
+            segment.pData = a_pData;
+            segment.ulSize = a_ulSize;
+            m_vSegments.push_back(segment);
+        }
+
+        bool OutputWriter::flush(int const a_iFd) noexcept {
+            bool bRes = true;
+#ifdef unix
+            m_vIoVecs.clear();
+            for (Segment const& segment : m_vSegments) {
+                char const* pData{ segment.pData ? segment.pData : m_strArena.data() + segment.ulOffset };
+                m_vIoVecs.push_back({ const_cast<char*>(pData), segment.ulSize });
+            }
+            size_t ulFirst{ 0 };
+            while (bRes && ulFirst < m_vIoVecs.size()) {
+                int const iCount{ static_cast<int>(min<size_t>(m_vIoVecs.size() - ulFirst, IOV_MAX)) };
+                ssize_t lWritten{ writev(a_iFd, &m_vIoVecs[ulFirst], iCount) };
+                if (lWritten < 0) {
+                    if (EAGAIN == errno || EWOULDBLOCK == errno) {
+                        // Non-blocking output: waits until it drains
+                        struct pollfd pollFd { a_iFd, POLLOUT, 0 };
+                        poll(&pollFd, 1, -1);
+                    }
+                    else if (EINTR != errno) {
+                        bRes = false;
+                    }
+                    continue;
+                }
+                // Skips what has been written, a partially written segment is resumed where it stopped
+                while (lWritten > 0) {
+                    struct iovec& rIoVec = m_vIoVecs[ulFirst];
+                    size_t const ulWritten{ min<size_t>(rIoVec.iov_len, static_cast<size_t>(lWritten)) };
+                    rIoVec.iov_base = static_cast<char*>(rIoVec.iov_base) + ulWritten;
+                    rIoVec.iov_len -= ulWritten;
+                    lWritten -= static_cast<ssize_t>(ulWritten);
+                    if (0 == rIoVec.iov_len) {
+                        ++ulFirst;
+                    }
+                }
+                while (ulFirst < m_vIoVecs.size() && 0 == m_vIoVecs[ulFirst].iov_len) {
+                    ++ulFirst;
+                }
+            }
+#else
+            // The console output goes through the C runtime, which translates it for the Windows console
+            (void)a_iFd;
+            for (Segment const& segment : m_vSegments) {
+                char const* pData{ segment.pData ? segment.pData : m_strArena.data() + segment.ulOffset };
+                bRes = segment.ulSize == fwrite(pData, 1, segment.ulSize, stdout) && bRes;
+            }
+            fflush(stdout);
+#endif
+            clear();
+            return bRes;
+        }
+    } // console
+} // emb
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#ifdef unix
+#include <sys/uio.h>
+#endif
+
+namespace emb {
+    namespace console {
+        /**
+         * @brief Output of a terminal frame: a list of segments flushed with a single scatter-gather write.
+         *        Copied data is appended into an arena that keeps its memory from a frame to another, data that outlives the
+         *        frame (literals, rendered batches) is only referenced. Data is written as is, null characters included.
+         */
+        class OutputWriter {
+        public:
+            OutputWriter() noexcept = default;
+            OutputWriter(OutputWriter const&) = delete;
+            OutputWriter(OutputWriter&&) = delete;
+            ~OutputWriter() noexcept = default;
+            OutputWriter& operator= (OutputWriter const&) = delete;
+            OutputWriter& operator= (OutputWriter&&) = delete;
+
+            bool empty() const noexcept { return m_vSegments.empty(); }
+            /// Removes all the segments but keeps the allocated memory for the next frame
+            void clear() noexcept;
+
+            /**
+             * @brief Appends a copy of data
+             * @param a_pData   Data
+             * @param a_ulSize  Size of the data
+             */
+            void append(char const* a_pData, size_t a_ulSize) noexcept;
+            /**
+             * @brief Appends data without copying it
+             * @param a_pData   Data, which must stay valid until the next flush() or clear()
+             * @param a_ulSize  Size of the data
+             */
+            void appendReference(char const* a_pData, size_t a_ulSize) noexcept;
+
+            /**
+             * @brief Writes all the segments, in order, then clears the writer
+             * @param a_iFd     File descriptor to write to
+             * @return bool     True if all the data has been written
+             */
+            bool flush(int const a_iFd) noexcept;
+
+        private:
+            struct Segment {
+                char const* pData{ nullptr };   ///< Referenced data, nullptr if the data is in the arena
+                size_t ulOffset{ 0 };           ///< Offset of the data in the arena: the arena may move while it grows
+                size_t ulSize{ 0 };
+            };
+
+        private:
+            std::string m_strArena{};
+            std::vector<Segment> m_vSegments{};
+#ifdef unix
+            std::vector<struct iovec> m_vIoVecs{};
+#endif
+        };
+    } // console
+} // emb
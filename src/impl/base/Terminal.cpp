@@ -1,22 +1,36 @@
 #include "Terminal.hpp"
+#include "../EventLoop.hpp"
 #include <iostream>
 #include <algorithm>
-#include <iterator>
 #include <unordered_map>
 #include <condition_variable>
-#include <sstream>
 
 namespace emb {
     namespace console {
         using namespace std;
 
+        namespace {
+            /// Capacity of the ring holding the committed batches: a power of 2 that can hold the maximum number of records
+            size_t queueCapacity(size_t const a_ulMaxRecords) noexcept {
+                size_t ulCapacity{ 2 };
+                while (ulCapacity < a_ulMaxRecords) {
+                    ulCapacity <<= 1;
+                }
+                return ulCapacity;
+            }
+        }
+
         Terminal::Terminal(ConsoleSessionWithTerminal& a_Console) noexcept
             : m_rConsoleSession(a_Console)
+            , m_pPrintQueue{ make_unique<emb::tools::BoundedQueue<SharedPrintBatch>>(queueCapacity(m_OutputQueuePolicy.ulMaxRecords)) }
             , m_pFunctions{ make_shared<Functions>(m_rConsoleSession) }
             , m_strCurrentUser{ "user" }
             , m_strCurrentMachine{ "machine" }
             , m_strCurrentFolder{ "/" } {
 
+            // The argument completers run in the background, the prompt is refreshed once their results are there
+            m_pFunctions->setAutoCompletionReadyEvt([this] { wakeUpEventLoop(); });
+
             // the "cd" command allows the user to navigate among console directories
             m_pFunctions->addCommand(UserCommandInfo("/cd", "Change the shell working directory"),
                 //---------- The 1rs lamba is called when the user call the "cd" command ----------
@@ -64,7 +78,12 @@ namespace emb {
                     // We need to find information about what the user is typing:
                     string strPrefixFolder{}; // what complete folder the user typed
                     string strPartialArg{a_AcData.partialArg}; // what partial folder the user started to typed
-                    string strCurrentFolder{m_strCurrentFolder}; // what folder we need to search the choices into
+                    string strCurrentFolder{}; // what folder we need to search the choices into
+                    {
+                        // The completer does not run on the console thread
+                        lock_guard<recursive_mutex> l{ m_Mutex };
+                        strCurrentFolder = m_strCurrentFolder;
+                    }
                     if(string::npos != ulPos) {
                         // if a complete folder has already been typed, it is the part before the last '/'
                         strPrefixFolder = a_AcData.partialArg.substr(0, ulPos+1);
@@ -97,6 +116,9 @@ namespace emb {
         /*Terminal::Terminal(Terminal&&) noexcept {
         }*/
         Terminal::~Terminal() noexcept {
+            // The functions may outlive the terminal when a running command still holds them
+            m_pFunctions->setAutoCompletionReadyEvt(nullptr);
+            m_pFunctions->cancelAutoCompletion();
         }
         /*Terminal& Terminal::operator= (Terminal const&) noexcept {
             return *this;
@@ -106,6 +128,7 @@ namespace emb {
         }*/
 
         void Terminal::start() noexcept {
+            m_bOutputQueueClosed = false;
             begin();
             setCursorVisible(false);
             commit();
@@ -114,22 +137,181 @@ namespace emb {
         }
 
         void Terminal::stop() noexcept {
+            {
+                // A command waiting for an answer would never end: its question is cancelled
+                lock_guard<recursive_mutex> const l{ m_Mutex };
+                if (PromptMode::Hidden != m_eCurrentPromptMode && PromptMode::Normal != m_eCurrentPromptMode && m_fctKeyPressed) {
+                    m_fctKeyPressed(Key::Escape, {});
+                }
+            }
             setPromptEnabled(false);
+            redrawCommandLine(true);
             begin();
             setCursorVisible(true);
             softReset();
             commit();
-            processPrintCommands(m_vpPrintCommands);
+            processPrintCommands();
+            // Nothing processes the queue anymore: the blocked producers must not wait for it
+            {
+                lock_guard<mutex> l{ m_OutputQueueMutex };
+                m_bOutputQueueClosed = true;
+            }
+            m_OutputQueueNotFull.notify_all();
         }
 
-        void Terminal::setPrintCommands(PrintCommand::VPtr const& a_vpPrintCommands, bool a_bInstantPrint) noexcept {
+        void Terminal::setPrintCommands(SharedPrintBatch const& a_PrintBatch, bool a_bInstantPrint) noexcept {
             if (a_bInstantPrint /* true if attached to gdb and if option set*/) {
-                processPrintCommands(a_vpPrintCommands);
+                processPrintCommands(*a_PrintBatch);
             }
             else {
-                lock_guard<recursive_mutex> l{ m_Mutex };
-                m_vpPrintCommands.insert(m_vpPrintCommands.end(), a_vpPrintCommands.begin(), a_vpPrintCommands.end());
+                SharedPrintBatch printBatch{ a_PrintBatch };
+                if (queuePrintCommands(printBatch)) {
+                    wakeUpEventLoop();
+                }
+            }
+        }
+
+        void Terminal::setSinkOptions(string const& a_strSinkName, OptionSink const& a_Option) noexcept {
+            m_strSinkName = a_strSinkName;
+            m_OutputQueuePolicy = a_Option.outputQueue;
+            m_OutputQueuePolicy.ulMaxRecords = max<size_t>(1, m_OutputQueuePolicy.ulMaxRecords);
+            m_pPrintQueue = make_unique<emb::tools::BoundedQueue<SharedPrintBatch>>(queueCapacity(m_OutputQueuePolicy.ulMaxRecords));
+            m_MinRedrawInterval = chrono::steady_clock::duration::zero();
+            if (a_Option.uiMaxPromptRedrawRate > 0) {
+                m_MinRedrawInterval = chrono::duration_cast<chrono::steady_clock::duration>(chrono::seconds(1)) / a_Option.uiMaxPromptRedrawRate;
+            }
+        }
+
+        OutputQueueStats Terminal::getOutputQueueStats() const noexcept {
+            OutputQueueStats stats{};
+            stats.strSink = m_strSinkName;
+            stats.ulQueuedRecords = m_ulQueuedRecords;
+            stats.ulQueuedBytes = m_ulQueuedBytes;
+            stats.ulDropped = m_ulDroppedRecords;
+            stats.ulSampled = m_ulSampledRecords;
+            stats.ulBlocked = m_ulBlockedProducers;
+            return stats;
+        }
+
+        bool Terminal::isOutputQueueBlocking() const noexcept {
+            return OutputQueuePolicy::Overflow::Block == m_OutputQueuePolicy.eOverflow && m_ulQueuedRecords > 0 &&
+                (m_ulQueuedRecords >= m_OutputQueuePolicy.ulMaxRecords || m_ulQueuedBytes >= m_OutputQueuePolicy.ulMaxBytes);
+        }
+
+        bool Terminal::flushBlockingOutputQueue() noexcept {
+            if (isOutputQueueBlocking()) {
+                processPrintCommands();
+            }
+            return !isOutputQueueBlocking();
+        }
+
+        bool Terminal::queuePrintCommands(SharedPrintBatch& a_rPrintBatch) noexcept {
+            size_t const ulBytes{ a_rPrintBatch->size() };
+            bool bReserved{ tryReserveOutputQueue(ulBytes) };
+            if (!bReserved) {
+                switch (m_OutputQueuePolicy.eOverflow) {
+                case OutputQueuePolicy::Overflow::Block:
+                    // The console thread cannot wait for itself (e.g. prints of the standard output capture): its batch is dropped
+                    if (!isConsoleThread()) {
+                        ++m_ulBlockedProducers;
+                        unique_lock<mutex> lock{ m_OutputQueueMutex };
+                        ++m_uiWaitingProducers;
+                        m_OutputQueueNotFull.wait(lock, [this, ulBytes, &bReserved]() {
+                            return m_bOutputQueueClosed || (bReserved = tryReserveOutputQueue(ulBytes));
+                        });
+                        --m_uiWaitingProducers;
+                    }
+                    break;
+                case OutputQueuePolicy::Overflow::DropNewest:
+                    break;
+                case OutputQueuePolicy::Overflow::Sample:
+                    if (m_OutputQueuePolicy.uiSampleRate > 1 && 0 != m_ulOverflowCount++ % m_OutputQueuePolicy.uiSampleRate) {
+                        ++m_ulSampledRecords;
+                        return false;
+                    }
+                    // The sampled batch is kept, as with DropOldest
+                    bReserved = reserveByDroppingOldest(ulBytes);
+                    break;
+                case OutputQueuePolicy::Overflow::DropOldest:
+                    bReserved = reserveByDroppingOldest(ulBytes);
+                    break;
+                }
+            }
+            // The reservation guarantees a free slot in the ring
+            if (bReserved && !m_pPrintQueue->tryPush(a_rPrintBatch)) {
+                releaseOutputQueue(ulBytes);
+                bReserved = false;
+            }
+            if (!bReserved) {
+                ++m_ulDroppedRecords;
             }
+            return bReserved;
+        }
+
+        bool Terminal::tryReserveOutputQueue(size_t const a_ulBytes) noexcept {
+            size_t const ulRecords{ m_ulQueuedRecords.fetch_add(1) + 1 };
+            size_t const ulBytes{ m_ulQueuedBytes.fetch_add(a_ulBytes) + a_ulBytes };
+            // A batch bigger than the byte limit is accepted by an empty queue, otherwise it could never be printed
+            if (ulRecords <= m_OutputQueuePolicy.ulMaxRecords && (ulBytes <= m_OutputQueuePolicy.ulMaxBytes || 1 == ulRecords)) {
+                return true;
+            }
+            m_ulQueuedRecords.fetch_sub(1);
+            m_ulQueuedBytes.fetch_sub(a_ulBytes);
+            return false;
+        }
+
+        void Terminal::releaseOutputQueue(size_t const a_ulBytes) noexcept {
+            m_ulQueuedRecords.fetch_sub(1);
+            m_ulQueuedBytes.fetch_sub(a_ulBytes);
+            if (m_uiWaitingProducers > 0) {
+                // Taking the lock ensures a producer is either before its check of the room or really waiting
+                { lock_guard<mutex> l{ m_OutputQueueMutex }; }
+                m_OutputQueueNotFull.notify_all();
+            }
+        }
+
+        bool Terminal::reserveByDroppingOldest(size_t const a_ulBytes) noexcept {
+            bool bReserved{ false };
+            while (!bReserved && dropOldestPrintCommands()) {
+                bReserved = tryReserveOutputQueue(a_ulBytes);
+            }
+            return bReserved;
+        }
+
+        bool Terminal::dropOldestPrintCommands() noexcept {
+            SharedPrintBatch printBatch{};
+            if (m_pPrintQueue->tryPop(printBatch)) {
+                releaseOutputQueue(printBatch->size());
+                ++m_ulDroppedRecords;
+                return true;
+            }
+            return false;
+        }
+
+        chrono::steady_clock::time_point Terminal::getNextTimeout() const noexcept {
+            lock_guard<recursive_mutex> l{ m_Mutex };
+            // The prints held back during a resize must be processed once it is over
+            if (isTerminalBeingResized()) {
+                return m_LastResizeEvent + chrono::milliseconds(500);
+            }
+            // A prompt redraw postponed by the rate limit
+            if (m_bCommandLineDirty) {
+                return m_NextRedraw;
+            }
+            // A completion that must be reported as timed out
+            return m_pFunctions->getAutoCompletionDeadline();
+        }
+
+        void Terminal::wakeUpEventLoop() const noexcept {
+            EventLoop* const pEventLoop{ m_pEventLoop.load() };
+            if (pEventLoop) {
+                pEventLoop->wakeUp();
+            }
+        }
+
+        bool Terminal::isConsoleThread() const noexcept {
+            EventLoop* const pEventLoop{ m_pEventLoop.load() };
+            return pEventLoop && pEventLoop->isCurrentThread();
         }
 
         template<typename T>
@@ -230,7 +412,7 @@ namespace emb {
                     commit();
                     return bUserEntryIsValid;
                 }, [&](Key const& a_eKey, std::string const& a_strPrintableData) {
-                    if (Key::Escape == a_eKey) {
+                    if (Key::Escape == a_eKey || Key::CtrlC == a_eKey) {
                         begin();
                         setColor(SetColor::Color::BrightYellow, SetColor::Color::Default);
                         printText("<CANCELED>");
@@ -298,7 +480,7 @@ namespace emb {
                             }
                         }
                     }
-                    else if (Key::Escape == a_eKey) {
+                    else if (Key::Escape == a_eKey || Key::CtrlC == a_eKey) {
                         begin();
                         setColor(SetColor::Color::BrightYellow, SetColor::Color::Default);
                         printText("<CANCELED>");
@@ -381,7 +563,7 @@ namespace emb {
                             }
                         }
                     }
-                    else if (Key::Escape == a_eKey) {
+                    else if (Key::Escape == a_eKey || Key::CtrlC == a_eKey) {
                         begin();
                         setColor(SetColor::Color::BrightYellow, SetColor::Color::Default);
                         printText("<CANCELED>");
@@ -484,6 +666,25 @@ namespace emb {
             m_strCurrentMachine = a_strMachineName;
         }
 
+        void Terminal::setCommonCommands(shared_ptr<CommandRegistry> const& a_pCommands) noexcept {
+            m_pFunctions->setCommonCommands(a_pCommands);
+        }
+
+        void Terminal::setCommandMetrics(shared_ptr<CommandMetrics> const& a_pMetrics) noexcept {
+            m_pFunctions->setCommandMetrics(a_pMetrics);
+        }
+
+        void Terminal::setHistory(shared_ptr<CommandHistory> const& a_pHistory) noexcept {
+            lock_guard<recursive_mutex> const l{ m_Mutex };
+            if (m_pHistory != a_pHistory) {
+                m_pHistory = a_pHistory;
+                m_iCurrentPositionInPreviousEntries = -1;
+                m_bHistorySearch = false;
+                m_ulHistorySearchAge = string::npos;
+                m_ulHistoryCount = a_pHistory->count();
+            }
+        }
+
         void Terminal::addCommand(UserCommandInfo const& a_CommandInfo, UserCommandFunctor0 const& a_funcCommandFunctor,
                                   UserCommandAutoCompleteFunctor const& a_funcAutoCompleteFunctor) noexcept {
             return m_pFunctions->addCommand(a_CommandInfo, a_funcCommandFunctor, a_funcAutoCompleteFunctor);
@@ -502,33 +703,41 @@ namespace emb {
             return m_pFunctions->delAllCommands();
         }
 
-        void Terminal::execCommand(UserCommandInfo const& a_CommandInfo, UserCommandData::Args const& a_CommandArgs) noexcept {
-            std::ostringstream joinedArgs;
-            std::copy(a_CommandArgs.begin(), a_CommandArgs.end(), std::ostream_iterator<std::string>(joinedArgs, " "));
-
-            lock_guard<recursive_mutex> l{ m_Mutex };
-            m_vUserEntries.push_back(Functions::UserEntry{ a_CommandInfo.path + " " + joinedArgs.str(), m_strCurrentFolder });
-        }
-
         void Terminal::setPromptEnabled(bool a_bPromptEnabled) {
             lock_guard<recursive_mutex> l{ m_Mutex };
             m_bPromptEnabled = a_bPromptEnabled;
-            printCommandLine();
+            invalidateCommandLine();
         }
 
-        void Terminal::processPrintCommands(PrintCommand::VPtr const& a_vpPrintCommands) noexcept {
+        void Terminal::processPrintCommands() noexcept {
             if (isPrintCommandEnabled() && !isTerminalBeingResized()) {
-                PrintCommand::VPtr vpPrintCommands{ a_vpPrintCommands };
-                if (vpPrintCommands.size() <= 0) {
-                    lock_guard<recursive_mutex> l{ m_Mutex };
-                    vpPrintCommands = m_vpPrintCommands;
-                    m_vpPrintCommands.clear();
+                bool bPrinted{ false };
+                bool bQueueEmpty{ false };
+                // At most one queue length is processed, so that a continuous flow of prints cannot starve the user inputs
+                for (size_t i = 0; i < m_pPrintQueue->capacity() && !bQueueEmpty; ++i) {
+                    SharedPrintBatch printBatch{};
+                    bQueueEmpty = !m_pPrintQueue->tryPop(printBatch);
+                    if (!bQueueEmpty) {
+                        replayPrintCommands(printBatch);
+                        releaseOutputQueue(printBatch->size());
+                        bPrinted = true;
+                    }
                 }
-
-                for (auto const& printCommand : vpPrintCommands) {
-                    printCommand->process(*this);
+                if (bPrinted) {
+                    invalidateCommandLine();
+                }
+                // The remaining batches are processed by the next loop iteration, which must not wait for a new event
+                if (!bQueueEmpty) {
+                    wakeUpEventLoop();
                 }
-                if (vpPrintCommands.size() > 0) {
+            }
+            redrawCommandLine();
+        }
+
+        void Terminal::processPrintCommands(PrintBatch const& a_PrintBatch) noexcept {
+            if (isPrintCommandEnabled() && !isTerminalBeingResized()) {
+                a_PrintBatch.replay(*this);
+                if (!a_PrintBatch.empty()) {
                     printCommandLine();
                 }
             }
@@ -538,11 +747,28 @@ namespace emb {
             Functions::VUserEntries vUserEntries;
             {
                 lock_guard<recursive_mutex> l{ m_Mutex };
-                vUserEntries = m_vUserEntries;
-                m_vUserEntries.clear();
+                vUserEntries.swap(m_vUserEntries);
+
+                switch (m_pFunctions->pollAutoCompletion()) {
+                case Functions::AutoCompletionState::Ready:
+                    // The entry did not change since <Tab>: the choices are applied as if <Tab> was pressed again
+                    if (m_pFunctions->processAutoCompletion(m_strCurrentEntry, m_uiCurrentCursorPosition, m_strCurrentFolder, true)) {
+                        m_uiCurrentWindowPosition = 0;
+                        m_uiCurrentWindowSize = min<unsigned int>(m_uiMaxPromptSize, m_strCurrentEntry.size());
+                    }
+                    invalidateCommandLine();
+                    break;
+                case Functions::AutoCompletionState::TimedOut:
+                    ringBell();
+                    invalidateCommandLine();
+                    break;
+                case Functions::AutoCompletionState::None:
+                case Functions::AutoCompletionState::Pending:
+                    break;
+                }
             }
-            for (auto const& elm : vUserEntries) {
-                m_pFunctions->processEntry(elm);
+            for (auto& elm : vUserEntries) {
+                m_pFunctions->processEntry(std::move(elm));
             }
         }
 
@@ -553,8 +779,8 @@ namespace emb {
             const auto debugHistory = [&]() {
                 if (enableDebugHistory) {
                     cout << endl << endl << "==== HISTORY ====" << endl;
-                    for (auto const& elm : m_vstrPreviousEntries) {
-                        cout << elm << endl;
+                    for (size_t ulAge = m_pHistory->size(); ulAge > 0; --ulAge) {
+                        cout << m_pHistory->get(ulAge - 1) << endl;
                     }
                     cout << m_iCurrentPositionInPreviousEntries << endl;
                     cout << "=== !HISTORY! ===" << endl;
@@ -568,17 +794,26 @@ namespace emb {
                 }
             }
 
+            // Any other key than <Tab> changes the entry, or validates it: the running completion is useless
+            if (Key::Tab != a_eKey && Key::ReverseTab != a_eKey) {
+                m_pFunctions->cancelAutoCompletion();
+            }
+
+            // During a reverse search, the keys edit the text searched, the other keys end the search
+            if (bContinue && m_bHistorySearch) {
+                bContinue = !processHistorySearchKey(a_eKey, a_strValue);
+            }
+
             if (bContinue) {
                 switch (a_eKey)
                 {
                 case Key::Enter:
                     if (m_bPromptEnabled && PromptMode::Normal == m_eCurrentPromptMode) {
                         m_vUserEntries.push_back(Functions::UserEntry{ m_strCurrentEntry, m_strCurrentFolder });
+                        wakeUpEventLoop();
                         printCommandLine(true);
                         m_iCurrentPositionInPreviousEntries = -1;
-                        if (!m_strCurrentEntry.empty()) {
-                            m_vstrPreviousEntries.insert(m_vstrPreviousEntries.begin(), m_strCurrentEntry);
-                        }
+                        m_pHistory->add(m_strCurrentEntry);
                         m_uiCurrentCursorPosition = 0;
                         m_uiCurrentWindowPosition = 0;
                         m_uiCurrentWindowSize = 0;
@@ -640,13 +875,14 @@ namespace emb {
                     break;
                 case Key::Up:
                     if (m_bPromptEnabled && PromptMode::Normal == m_eCurrentPromptMode) {
-                        if (m_iCurrentPositionInPreviousEntries < static_cast<int>(m_vstrPreviousEntries.size() - 1)) {
+                        followHistory();
+                        if (m_iCurrentPositionInPreviousEntries + 1 < static_cast<int>(m_pHistory->size())) {
                             if (-1 == m_iCurrentPositionInPreviousEntries) {
                                 m_strSavedEntry = m_strCurrentEntry;
                             }
                             ++m_iCurrentPositionInPreviousEntries;
                             m_uiCurrentCursorPosition = 0;
-                            m_strCurrentEntry = m_vstrPreviousEntries.at(m_iCurrentPositionInPreviousEntries);
+                            m_strCurrentEntry = m_pHistory->get(m_iCurrentPositionInPreviousEntries);
                             m_uiCurrentWindowPosition = 0;
                             m_uiCurrentWindowSize = min<unsigned int>(m_uiMaxPromptSize, m_strCurrentEntry.size());
                         }
@@ -658,6 +894,7 @@ namespace emb {
                     break;
                 case Key::Down:
                     if (m_bPromptEnabled && PromptMode::Normal == m_eCurrentPromptMode) {
+                        followHistory();
                         if (m_iCurrentPositionInPreviousEntries >= 0) {
                             --m_iCurrentPositionInPreviousEntries;
                             m_uiCurrentCursorPosition = 0;
@@ -666,7 +903,7 @@ namespace emb {
                                 m_strSavedEntry.clear();
                             }
                             else {
-                                m_strCurrentEntry = m_vstrPreviousEntries.at(m_iCurrentPositionInPreviousEntries);
+                                m_strCurrentEntry = m_pHistory->get(m_iCurrentPositionInPreviousEntries);
                             }
                             m_uiCurrentWindowPosition = 0;
                             m_uiCurrentWindowSize = min<unsigned int>(m_uiMaxPromptSize, m_strCurrentEntry.size());
@@ -725,6 +962,35 @@ namespace emb {
                     break;
                 case Key::Escape:
                     break;
+                case Key::CtrlC:
+                    // During a question, Ctrl-C only cancels the question
+                    if (PromptMode::Normal == m_eCurrentPromptMode || PromptMode::Hidden == m_eCurrentPromptMode) {
+                        bool const bCancelled{ m_pFunctions->cancelForegroundCommand() };
+                        if (m_bPromptEnabled && PromptMode::Normal == m_eCurrentPromptMode && (bCancelled || !m_strCurrentEntry.empty())) {
+                            // Like a shell, the interrupted entry is kept on screen and a new one is started
+                            m_strCurrentEntry += "^C";
+                            printCommandLine(true);
+                            m_iCurrentPositionInPreviousEntries = -1;
+                            m_uiCurrentCursorPosition = 0;
+                            m_uiCurrentWindowPosition = 0;
+                            m_uiCurrentWindowSize = 0;
+                            m_strCurrentEntry.clear();
+                        }
+                        else if (!bCancelled) {
+                            interruptApplication();
+                        }
+                    }
+                    break;
+                case Key::CtrlR:
+                    if (m_bPromptEnabled && PromptMode::Normal == m_eCurrentPromptMode) {
+                        m_bHistorySearch = true;
+                        m_strHistorySearch.clear();
+                        m_ulHistorySearchAge = string::npos;
+                        m_strHistorySearchMatch.clear();
+                        m_bHistorySearchFailed = false;
+                        m_strEntryBeforeSearch = m_strCurrentEntry;
+                    }
+                    break;
                 case Key::F1:
                     m_bPrintCommandEnabled = !m_bPrintCommandEnabled;
                     break;
@@ -767,7 +1033,82 @@ namespace emb {
                 }
             }
 
-            printCommandLine();
+            invalidateCommandLine();
+        }
+
+        bool Terminal::processHistorySearchKey(Key const& a_eKey, std::string const& a_strValue) noexcept {
+            if (!m_bPromptEnabled || PromptMode::Normal != m_eCurrentPromptMode) {
+                m_bHistorySearch = false;
+                return false;
+            }
+            followHistory();
+            switch (a_eKey) {
+            case Key::Printable:
+                m_strHistorySearch += a_strValue;
+                // The entry found may still match the longer text
+                searchHistory(string::npos == m_ulHistorySearchAge ? 0 : m_ulHistorySearchAge);
+                return true;
+            case Key::Back:
+                if (m_strHistorySearch.empty()) {
+                    ringBell();
+                }
+                else {
+                    m_strHistorySearch.pop_back();
+                    searchHistory(0);
+                }
+                return true;
+            case Key::CtrlR:
+                searchHistory(string::npos == m_ulHistorySearchAge ? 0 : m_ulHistorySearchAge + 1);
+                return true;
+            case Key::CtrlC:
+            case Key::Escape:
+                m_bHistorySearch = false;
+                m_strCurrentEntry = m_strEntryBeforeSearch;
+                break;
+            default:
+                // Like a shell, the entry found is kept and the key is processed as usual
+                m_bHistorySearch = false;
+                if (string::npos != m_ulHistorySearchAge) {
+                    if (-1 == m_iCurrentPositionInPreviousEntries) {
+                        m_strSavedEntry = m_strEntryBeforeSearch;
+                    }
+                    m_iCurrentPositionInPreviousEntries = static_cast<int>(m_ulHistorySearchAge);
+                    m_strCurrentEntry = m_strHistorySearchMatch;
+                }
+                break;
+            }
+            m_uiCurrentCursorPosition = m_strCurrentEntry.size();
+            m_uiCurrentWindowSize = min<unsigned int>(m_uiMaxPromptSize, m_strCurrentEntry.size());
+            m_uiCurrentWindowPosition = m_strCurrentEntry.size() - m_uiCurrentWindowSize;
+            return Key::CtrlC == a_eKey || Key::Escape == a_eKey;
+        }
+
+        void Terminal::followHistory() noexcept {
+            size_t const ulCount{ m_pHistory->count() };
+            if (ulCount != m_ulHistoryCount) {
+                size_t const ulAdded{ ulCount - m_ulHistoryCount };
+                // The entries browsed or found may have been overwritten since, the oldest one is used instead
+                size_t const ulOldestAge{ m_pHistory->size() - 1 };
+                if (m_iCurrentPositionInPreviousEntries >= 0) {
+                    m_iCurrentPositionInPreviousEntries = static_cast<int>(min(static_cast<size_t>(m_iCurrentPositionInPreviousEntries) + ulAdded, ulOldestAge));
+                }
+                if (string::npos != m_ulHistorySearchAge) {
+                    m_ulHistorySearchAge = min(m_ulHistorySearchAge + ulAdded, ulOldestAge);
+                }
+            }
+            m_ulHistoryCount = ulCount;
+        }
+
+        void Terminal::searchHistory(size_t const a_ulFromAge) noexcept {
+            size_t const ulAge{ m_pHistory->search(m_strHistorySearch, a_ulFromAge) };
+            m_bHistorySearchFailed = string::npos == ulAge;
+            if (m_bHistorySearchFailed) {
+                ringBell();
+            }
+            else {
+                m_ulHistorySearchAge = ulAge;
+                m_strHistorySearchMatch = m_pHistory->get(ulAge);
+            }
         }
 
         void Terminal::setPromptMode(PromptMode const& a_ePromptMode,
@@ -776,7 +1117,23 @@ namespace emb {
             m_eCurrentPromptMode = a_ePromptMode;
             m_fctFinished = a_fctFinished;
             m_fctKeyPressed = a_fctKeyPressed;
-            printCommandLine();
+            invalidateCommandLine();
+        }
+
+        void Terminal::invalidateCommandLine() noexcept {
+            // The console thread redraws it at the end of its current iteration, or when the rate limit allows it
+            if (!m_bCommandLineDirty.exchange(true) && !isConsoleThread()) {
+                wakeUpEventLoop();
+            }
+        }
+
+        void Terminal::redrawCommandLine(bool const a_bForce) noexcept {
+            auto const now = chrono::steady_clock::now();
+            if (m_bCommandLineDirty && (a_bForce || now >= m_NextRedraw)) {
+                m_bCommandLineDirty = false;
+                m_NextRedraw = now + m_MinRedrawInterval;
+                printCommandLine();
+            }
         }
 
         void Terminal::printCommandLine(bool const& a_bPrintInText) const noexcept {
@@ -841,25 +1198,41 @@ namespace emb {
                 clearDisplay(ClearDisplay::Type::FromCursorToEnd);
                 moveCursorToPosition(999, 1);
 
-                printCommonPart();
-                if (m_uiCurrentWindowPosition > 0) {
-                    setColor(SetColor::Color::BrightYellow, SetColor::Color::Magenta);
-                    moveCursorBackward(1);
-                    printText("<");
-                    resetTextFormat();
+                if (m_bHistorySearch) {
+                    string strLine{ (m_bHistorySearchFailed ? "(failed reverse-i-search)`" : "(reverse-i-search)`") + m_strHistorySearch + "': " };
+                    strLine += m_strHistorySearchMatch;
+                    if (m_CurrentSize.iWidth > 1 && strLine.size() >= static_cast<size_t>(m_CurrentSize.iWidth)) {
+                        strLine.resize(m_CurrentSize.iWidth - 1);
+                    }
+                    printText(strLine);
                 }
+                else {
+                    printCommonPart();
+                    if (m_uiCurrentWindowPosition > 0) {
+                        setColor(SetColor::Color::BrightYellow, SetColor::Color::Magenta);
+                        moveCursorBackward(1);
+                        printText("<");
+                        resetTextFormat();
+                    }
 
-                string strTmp{ m_strCurrentEntry + " " };
-                printText(strTmp.substr(m_uiCurrentWindowPosition, m_uiCurrentCursorPosition - m_uiCurrentWindowPosition));
-                setNegativeColors(true);
-                printText(strTmp.substr(m_uiCurrentCursorPosition, 1));
-                setNegativeColors(false);
-                printText(strTmp.substr(m_uiCurrentCursorPosition + 1, m_uiCurrentWindowPosition + m_uiCurrentWindowSize - m_uiCurrentCursorPosition - 1));
+                    string strTmp{ m_strCurrentEntry + " " };
+                    printText(strTmp.substr(m_uiCurrentWindowPosition, m_uiCurrentCursorPosition - m_uiCurrentWindowPosition));
+                    setNegativeColors(true);
+                    printText(strTmp.substr(m_uiCurrentCursorPosition, 1));
+                    setNegativeColors(false);
+                    printText(strTmp.substr(m_uiCurrentCursorPosition + 1, m_uiCurrentWindowPosition + m_uiCurrentWindowSize - m_uiCurrentCursorPosition - 1));
 
-                if (m_uiCurrentWindowPosition + m_uiCurrentWindowSize < m_strCurrentEntry.size()) {
-                    setColor(SetColor::Color::BrightYellow, SetColor::Color::Magenta);
-                    printText(">");
-                    resetTextFormat();
+                    if (m_uiCurrentWindowPosition + m_uiCurrentWindowSize < m_strCurrentEntry.size()) {
+                        setColor(SetColor::Color::BrightYellow, SetColor::Color::Magenta);
+                        printText(">");
+                        resetTextFormat();
+                    }
+
+                    if (PromptMode::Normal == m_eCurrentPromptMode && m_pFunctions->isAutoCompletionPending()) {
+                        setColor(SetColor::Color::BrightBlack, SetColor::Color::Default);
+                        printText(" completing...");
+                        resetTextFormat();
+                    }
                 }
 
                 restoreCursor();
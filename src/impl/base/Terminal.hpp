@@ -3,12 +3,19 @@
 #include "EmbConsole.hpp"
 #include "ITerminal.hpp"
 #include "../Functions.hpp"
+#include "../PrintBatch.hpp"
+#include "../BoundedQueue.hpp"
+#include "../CommandHistory.hpp"
 #include <string>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 
 namespace emb {
     namespace console {
         class ConsoleSessionWithTerminal;
+        class EventLoop;
         class Terminal : public ITerminal {
         public:
             struct Size {
@@ -49,9 +56,61 @@ namespace emb {
             void start() noexcept override;
             void stop() noexcept override;
 
-            void setPrintCommands(PrintCommand::VPtr const& a_vpPrintCommands, bool a_bInstantPrint) noexcept;
+            /**
+             * @brief Hands a committed batch of print commands over to the terminal
+             * @param a_PrintBatch      Committed batch, only referenced by the terminal
+             * @param a_bInstantPrint   Indicates if the batch must be printed right now, by the calling thread
+             */
+            void setPrintCommands(SharedPrintBatch const& a_PrintBatch, bool a_bInstantPrint) noexcept;
+            /**
+             * @brief Applies the options of the sink: limits of the queue of committed batches, overflow policy, prompt redraw rate.
+             *        Must be called before the terminal is started.
+             * @param a_strSinkName     Name of the sink in the statistics
+             * @param a_Option          Options of the sink
+             */
+            void setSinkOptions(std::string const& a_strSinkName, OptionSink const& a_Option) noexcept;
+            OutputQueueStats getOutputQueueStats() const noexcept;
+            /**
+             * @brief Tells if the queue of committed batches is full while its producers wait for room
+             *        (OutputQueuePolicy::Overflow::Block). The console thread cannot wait for itself: what it prints is dropped.
+             */
+            bool isOutputQueueBlocking() const noexcept;
+            /**
+             * @brief Processes a blocking queue of committed batches (see isOutputQueueBlocking()), called by the console
+             *        thread before it prints
+             * @return bool     True if the queue has room
+             */
+            bool flushBlockingOutputQueue() noexcept;
             void setPromptCommands(PromptCommand::VPtr const& a_vpPromptCommands) noexcept;
 
+            /**
+             * @brief Sets the event loop of the console thread, woken up each time the terminal has something to process
+             * @param a_pEventLoop  Event loop, must outlive the terminal. Must be set before the terminal is started.
+             */
+            void setEventLoop(EventLoop* a_pEventLoop) noexcept { m_pEventLoop = a_pEventLoop; }
+            /**
+             * @brief Cancels all the commands started from the terminal, waiting or running
+             */
+            void cancelCommands() noexcept { m_pFunctions->cancelCommands(); }
+            /**
+             * @brief Tells if commands started from the terminal are waiting or running
+             */
+            bool hasRunningCommands() const noexcept { return m_pFunctions->hasRunningCommands(); }
+            /**
+             * @brief Cancels all the commands started from the terminal, then waits for them to end
+             */
+            void stopCommands() noexcept { m_pFunctions->stopCommands(); }
+            /**
+             * @brief Gives the file descriptor the terminal reads its inputs from, so that the console thread can wait for it
+             * @return int  The file descriptor, -1 if the inputs are not read from a pollable file descriptor
+             */
+            virtual int getInputFd() const noexcept { return -1; }
+            /**
+             * @brief Gives the time at which the console thread must call processEvents() even if no event occurred
+             * @return std::chrono::steady_clock::time_point    The time, time_point::max() if there is no pending timer
+             */
+            virtual std::chrono::steady_clock::time_point getNextTimeout() const noexcept;
+
             virtual bool supportsInteractivity() const noexcept { return false; }
             virtual bool supportsColor() const noexcept { return false; }
 
@@ -129,11 +188,23 @@ namespace emb {
             void setUserName(std::string const& a_strUserName) noexcept;
             void setMachineName(std::string const& a_strMachineName) noexcept;
 
+            /**
+             * @brief Sets the commands of the application, shared with the other terminals
+             */
+            void setCommonCommands(std::shared_ptr<CommandRegistry> const& a_pCommands) noexcept;
+            /**
+             * @brief Sets the execution counters of the commands, shared with the other terminals
+             */
+            void setCommandMetrics(std::shared_ptr<CommandMetrics> const& a_pMetrics) noexcept;
+            /**
+             * @brief Sets the history of the entries, shared with the other terminals
+             */
+            void setHistory(std::shared_ptr<CommandHistory> const& a_pHistory) noexcept;
+            /// Commands of this terminal only
             void addCommand(UserCommandInfo const&, UserCommandFunctor0 const&, UserCommandAutoCompleteFunctor const& = nullptr) noexcept;
             void addCommand(UserCommandInfo const&, UserCommandFunctor1 const&, UserCommandAutoCompleteFunctor const& = nullptr) noexcept;
             void delCommand(UserCommandInfo const&) noexcept;
             void delAllCommands() noexcept;
-            void execCommand(UserCommandInfo const&, UserCommandData::Args const&) noexcept;
 
             void setPromptEnabled(bool);
 
@@ -154,6 +225,8 @@ namespace emb {
                 PageDown,
                 Insert,
                 Escape,
+                CtrlC,
+                CtrlR,
                 F1,
                 F2,
                 F3,
@@ -170,9 +243,21 @@ namespace emb {
             };
 
         protected:
-            void processPrintCommands(PrintCommand::VPtr const& = PrintCommand::VPtr{}) noexcept;
+            void processPrintCommands() noexcept;
+            void processPrintCommands(PrintBatch const& a_PrintBatch) noexcept;
+            /**
+             * @brief Executes the commands of a committed batch, called by the console thread
+             * @param a_PrintBatch  Committed batch, possibly shared with other terminals
+             */
+            virtual void replayPrintCommands(SharedPrintBatch const& a_PrintBatch) noexcept { a_PrintBatch->replay(*this, &a_PrintBatch.formattedTexts()); }
             void processUserCommands() noexcept;
+            void wakeUpEventLoop() const noexcept;
+            bool isConsoleThread() const noexcept;
             void processPressedKey(Key const&, std::string const& = {}) noexcept;
+            /**
+             * @brief Called when Ctrl-C is pressed while there is neither a command to cancel nor an entry to discard
+             */
+            virtual void interruptApplication() noexcept {}
             void setCurrentSize(Size const& a_NewSize) noexcept {
                 std::lock_guard<std::recursive_mutex> l(m_Mutex);
                 if (m_CurrentSize != a_NewSize) {
@@ -204,14 +289,55 @@ namespace emb {
                 std::function<bool(bool const&, std::string const&)> const& a_fctFinished = nullptr,
                 std::function<bool(Key const&, std::string const&)> const& a_fctKeyPressed = nullptr
             ) noexcept;
+            /**
+             * @brief Processes a key pressed during a reverse search of the history
+             * @return bool     True if the key is consumed by the search, false if it ended the search and must be processed
+             */
+            bool processHistorySearchKey(Key const& a_eKey, std::string const& a_strValue) noexcept;
+            /**
+             * @brief Searches the history from a given entry, the entry found is kept if there is none
+             */
+            void searchHistory(size_t const a_ulFromAge) noexcept;
+            /**
+             * @brief Updates the position browsed and the entry found by the search with the entries added since, by any
+             *        terminal, so that they stay on the same entries
+             */
+            void followHistory() noexcept;
             void printCommandLine(bool const& a_bPrintInText = false) const noexcept;
+            void invalidateCommandLine() noexcept;
+            void redrawCommandLine(bool const a_bForce = false) noexcept;
+            bool queuePrintCommands(SharedPrintBatch& a_rPrintBatch) noexcept;
+            bool tryReserveOutputQueue(size_t const a_ulBytes) noexcept;
+            void releaseOutputQueue(size_t const a_ulBytes) noexcept;
+            bool dropOldestPrintCommands() noexcept;
+            /**
+             * @brief Drops the oldest batches of the queue until a batch fits in it
+             * @return bool     True if the batch is reserved, false if it does not fit in the empty queue
+             */
+            bool reserveByDroppingOldest(size_t const a_ulBytes) noexcept;
 
         private:
             ConsoleSessionWithTerminal& m_rConsoleSession;
+            std::atomic<EventLoop*> m_pEventLoop{ nullptr };     ///< Cleared before the event loop is destroyed
             mutable std::recursive_mutex m_Mutex{};
             mutable std::recursive_mutex m_PrintMutex{};
             bool m_bPrintCommandEnabled{ true };
-            PrintCommand::VPtr m_vpPrintCommands{};
+            std::string m_strSinkName{};
+            OutputQueuePolicy m_OutputQueuePolicy{};
+            std::unique_ptr<emb::tools::BoundedQueue<SharedPrintBatch>> m_pPrintQueue;    ///< Committed batches waiting for the console thread
+            std::atomic<size_t> m_ulQueuedRecords{ 0 };     ///< Batches reserved in the queue, released once processed or dropped
+            std::atomic<size_t> m_ulQueuedBytes{ 0 };
+            std::atomic<uint64_t> m_ulDroppedRecords{ 0 };
+            std::atomic<uint64_t> m_ulSampledRecords{ 0 };
+            std::atomic<uint64_t> m_ulBlockedProducers{ 0 };
+            std::atomic<uint64_t> m_ulOverflowCount{ 0 };   ///< Batches that found the queue full, used by the sampling
+            std::atomic<unsigned int> m_uiWaitingProducers{ 0 };
+            std::atomic<bool> m_bOutputQueueClosed{ false };
+            std::atomic<bool> m_bCommandLineDirty{ false };        ///< The prompt must be redrawn
+            std::chrono::steady_clock::duration m_MinRedrawInterval{};
+            std::chrono::steady_clock::time_point m_NextRedraw{};   ///< Earliest time of the next prompt redraw
+            std::mutex m_OutputQueueMutex{};
+            std::condition_variable m_OutputQueueNotFull{};
             std::shared_ptr<Functions> m_pFunctions;
             Functions::VUserEntries m_vUserEntries{};
             bool m_bPromptEnabled{ false };
@@ -224,9 +350,16 @@ namespace emb {
             unsigned int m_uiMaxPromptSize{ 0 };
             unsigned int m_uiCurrentWindowPosition{ 0 };
             unsigned int m_uiCurrentWindowSize{ 0 };
-            std::vector<std::string> m_vstrPreviousEntries{};
+            std::shared_ptr<CommandHistory> m_pHistory{ std::make_shared<CommandHistory>(OptionHistory{}) };
             int m_iCurrentPositionInPreviousEntries{ -1 };
+            size_t m_ulHistoryCount{ 0 };           ///< History count() the ages are relative to, the history being shared
             std::string m_strSavedEntry{};
+            bool m_bHistorySearch{ false };         ///< Reverse incremental search running (Ctrl-R)
+            std::string m_strHistorySearch{};       ///< Text searched
+            size_t m_ulHistorySearchAge{ std::string::npos };  ///< Age of the entry found, npos if none yet
+            std::string m_strHistorySearchMatch{};
+            bool m_bHistorySearchFailed{ false };   ///< The text searched is not found, the previous entry found is kept
+            std::string m_strEntryBeforeSearch{};   ///< Restored when the search is aborted
             Size m_CurrentSize{};
             Position m_CurrentCursorPosition{};
             std::chrono::steady_clock::time_point m_LastResizeEvent{};
@@ -2,7 +2,7 @@
 #include "../ConsolePrivate.hpp"
 #include "../Tools.hpp"
 #include <string>
-#include <unordered_map>
+#include <cstring>
 #if defined _MSC_VER || defined __MINGW32__
 #include <io.h>
 #define flockfile _lock_file
@@ -12,29 +12,93 @@
 #include <stdio.h>
 #endif
 
-#if __cplusplus < 201402L // Before C++14, std::map with an enum as key fails
-namespace std {
-    template<typename E>
-    struct hash {
-        typedef E argument_type;
-        typedef size_t result_type;
-        using sfinae = typename std::enable_if<std::is_enum<E>::value>::type;
-        result_type operator() (const E& e) const {
-            using base_t = typename std::underlying_type<E>::type;
-            return std::hash<base_t>()(static_cast<base_t>(e));
-        }
-    };
-}
-#endif
-
 namespace emb {
     namespace console {
         using namespace std;
 
-        static const string s_ESC{ "\033" };
-        static const string s_CSI{ "\033[" };
-        static const string s_OSC{ "\033]" };
-        static const string s_ST{ "\033\\" };
+        namespace {
+            /// Escape sequence known at compile time
+            struct Sequence {
+                char const* pData;
+                size_t ulSize;  ///< Without the terminating null character
+            };
+            template<size_t N>
+            constexpr Sequence sequence(char const (&a_szSequence)[N]) noexcept { return Sequence{ a_szSequence, N - 1 }; }
+
+            /// Indexed by SetCursorShape::Shape
+            constexpr Sequence s_aCursorShapes[]{
+                sequence("\033[0 q"),      // UserDefault
+                sequence("\033[1 q"),      // BlinkingBlock
+                sequence("\033[2 q"),      // SteadyBlock
+                sequence("\033[3 q"),      // BlinkingUnderline
+                sequence("\033[4 q"),      // SteadyUnderline
+                sequence("\033[5 q"),      // BlinkingBar
+                sequence("\033[6 q"),      // SteadyBar
+            };
+            /// Indexed by ClearDisplay::Type
+            constexpr Sequence s_aClearDisplays[]{
+                sequence("\033[0J"),       // FromCursorToEnd
+                sequence("\033[1J"),       // FromBeginningToCursor
+                sequence("\033[2J"),       // All
+            };
+            /// Indexed by ClearLine::Type
+            constexpr Sequence s_aClearLines[]{
+                sequence("\033[0K"),       // FromCursorToEnd
+                sequence("\033[1K"),       // FromBeginningToCursor
+                sequence("\033[2K"),       // All
+            };
+            /// Indexed by SetColor::Color: beginning of the SGR sequence, with the foreground color
+            constexpr Sequence s_aForegroundColors[]{
+                sequence("\033[30"), sequence("\033[31"), sequence("\033[32"), sequence("\033[33"),
+                sequence("\033[34"), sequence("\033[35"), sequence("\033[36"), sequence("\033[37"),
+                sequence("\033[90"), sequence("\033[91"), sequence("\033[92"), sequence("\033[93"),
+                sequence("\033[94"), sequence("\033[95"), sequence("\033[96"), sequence("\033[97"),
+                sequence("\033[37"),       // Default
+            };
+            /// Indexed by SetColor::Color: end of the SGR sequence, with the background color
+            constexpr Sequence s_aBackgroundColors[]{
+                sequence(";40m"), sequence(";41m"), sequence(";42m"), sequence(";43m"),
+                sequence(";44m"), sequence(";45m"), sequence(";46m"), sequence(";47m"),
+                sequence(";100m"), sequence(";101m"), sequence(";102m"), sequence(";103m"),
+                sequence(";104m"), sequence(";105m"), sequence(";106m"), sequence(";107m"),
+                sequence("m"),              // Default
+            };
+            /// Indexed by PrintSymbol::Symbol: character of the DEC special graphics set
+            constexpr char s_acSymbols[]{
+                ' ',    // Space
+                'j',    // BottomRight
+                'k',    // TopRight
+                'l',    // TopLeft
+                'm',    // BottomLeft
+                'n',    // Cross
+                'q',    // HorizontalBar
+                't',    // LeftCross
+                'u',    // RightCross
+                'v',    // BottomCross
+                'w',    // TopCross
+                'x',    // VerticalBar
+            };
+
+            size_t const s_ulMaxDecimalSize{ 10 };  ///< Digits of the greatest unsigned int
+
+            /**
+             * @brief Writes a number in decimal, without allocating
+             * @param a_pBuffer Buffer of at least s_ulMaxDecimalSize characters
+             * @param a_uiValue Number to write
+             * @return char*    End of the written digits
+             */
+            char* writeDecimal(char* a_pBuffer, unsigned int a_uiValue) noexcept {
+                char acDigits[s_ulMaxDecimalSize];
+                char* pDigit{ acDigits + s_ulMaxDecimalSize };
+                do {
+                    *--pDigit = static_cast<char>('0' + a_uiValue % 10);
+                    a_uiValue /= 10;
+                } while (0 != a_uiValue);
+                size_t const ulSize{ static_cast<size_t>(acDigits + s_ulMaxDecimalSize - pDigit) };
+                memcpy(a_pBuffer, pDigit, ulSize);
+                return a_pBuffer + ulSize;
+            }
+        }
 
         TerminalAnsi::TerminalAnsi(ConsoleSessionWithTerminal& a_rConsoleSession) noexcept : Terminal{ a_rConsoleSession } {
             a_rConsoleSession.setPeriodicCapture([this] {
@@ -53,12 +117,12 @@ namespace emb {
                 case DSRState::SizeRequest:
                     saveCursor();
                     moveCursorToPosition(999, 999);
-                    write(s_CSI + "6n"); // Device Status Report : Report Cursor Position
+                    output("\033[6n"); // Device Status Report : Report Cursor Position
                     restoreCursor();
                     commit();
                     break;
                 case DSRState::PositionRequest:
-                    write(s_CSI + "6n"); // Device Status Report : Report Cursor Position
+                    output("\033[6n"); // Device Status Report : Report Cursor Position
                     commit();
                     break;
                 }
@@ -105,10 +169,18 @@ namespace emb {
         }
 
         bool TerminalAnsi::write(std::string const& a_strDataToPrint) const noexcept {
-            m_strDataToPrint += a_strDataToPrint;
+            writeCopy(a_strDataToPrint.data(), a_strDataToPrint.size());
             return true;
         }
 
+        void TerminalAnsi::writeCopy(char const* a_pData, size_t a_ulSize) const noexcept {
+            m_Output.append(a_pData, a_ulSize);
+        }
+
+        void TerminalAnsi::writeReference(char const* a_pData, size_t a_ulSize) const noexcept {
+            m_Output.appendReference(a_pData, a_ulSize);
+        }
+
         void TerminalAnsi::processCapture() const noexcept {
             bool bLockOk = 0 == ftrylockfile(stdout);
             ConsoleSessionWithTerminal::endStdCapture();
@@ -118,20 +190,84 @@ namespace emb {
             }
         }
 
+        void TerminalAnsi::replayPrintCommands(SharedPrintBatch const& a_PrintBatch) noexcept {
+            // Held during the rendering, so that no other thread prints on the terminal in between
+            Terminal::begin();
+            unsigned int const uiRenderClass{ getRenderClass() };
+            string const* pstrBytes{ a_PrintBatch.findRendering(uiRenderClass) };
+            if (!pstrBytes) {
+                string& rstrBytes = a_PrintBatch.addRendering(uiRenderClass);
+                m_pstrRendering = &rstrBytes;
+                a_PrintBatch->replay(*this, &a_PrintBatch.formattedTexts());
+                m_pstrRendering = nullptr;
+                pstrBytes = &rstrBytes;
+            }
+            if (!pstrBytes->empty()) {
+                // The rendering belongs to the batch, which outlives the transaction
+                begin();
+                writeReference(pstrBytes->data(), pstrBytes->size());
+                commit();
+            }
+            Terminal::commit();
+        }
+
+        void TerminalAnsi::output(string const& a_strData) const noexcept {
+            output(a_strData.data(), a_strData.size());
+        }
+
+        void TerminalAnsi::output(char const* a_pData, size_t a_ulSize) const noexcept {
+            if (m_pstrRendering) {
+                m_strRenderedTransaction.append(a_pData, a_ulSize);
+            }
+            else {
+                // Copied once, straight where the terminal keeps its output
+                writeCopy(a_pData, a_ulSize);
+            }
+        }
+
+        void TerminalAnsi::outputCsi(unsigned int const a_uiN, char const a_cFinal) const noexcept {
+            char acSequence[2 + s_ulMaxDecimalSize + 1]{ '\033', '[' };
+            char* pEnd{ writeDecimal(acSequence + 2, a_uiN) };
+            *pEnd++ = a_cFinal;
+            output(acSequence, static_cast<size_t>(pEnd - acSequence));
+        }
+
+        void TerminalAnsi::outputCsi(unsigned int const a_uiN1, unsigned int const a_uiN2, char const a_cFinal) const noexcept {
+            char acSequence[2 + s_ulMaxDecimalSize + 1 + s_ulMaxDecimalSize + 1]{ '\033', '[' };
+            char* pEnd{ writeDecimal(acSequence + 2, a_uiN1) };
+            *pEnd++ = ';';
+            pEnd = writeDecimal(pEnd, a_uiN2);
+            *pEnd++ = a_cFinal;
+            output(acSequence, static_cast<size_t>(pEnd - acSequence));
+        }
+
         void TerminalAnsi::begin() const noexcept {
+            // While rendering, the transactions are recorded the same way they would have been output
+            if (m_pstrRendering) {
+                m_strRenderedTransaction.clear();
+                return;
+            }
             Terminal::begin();
-            m_strDataToPrint.clear();
+            m_Output.clear();
         }
 
         void TerminalAnsi::commit() const noexcept {
+            if (m_pstrRendering) {
+                *m_pstrRendering += m_strRenderedTransaction;
+                return;
+            }
+#ifdef unix
+            // The standard output stays captured: the frame is written directly to the real output
+            m_Output.flush(ConsoleSessionWithTerminal::getStdOutFd());
+#else
             bool bLockOk = 0 == ftrylockfile(stdout);
             ConsoleSessionWithTerminal::endStdCapture();
-            fprintf(stdout, "%s", m_strDataToPrint.c_str());
-            fflush(stdout);
+            m_Output.flush(fileno(stdout));
             ConsoleSessionWithTerminal::beginStdCapture();
             if (bLockOk) {
                 funlockfile(stdout);
             }
+#endif
             Terminal::commit();
         }
 
@@ -139,80 +275,80 @@ namespace emb {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "A");
+            outputCsi(a_uiN, 'A');
         }
 
         void TerminalAnsi::moveCursorDown(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "B");
+            outputCsi(a_uiN, 'B');
         }
 
         void TerminalAnsi::moveCursorForward(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "C");
+            outputCsi(a_uiN, 'C');
         }
 
         void TerminalAnsi::moveCursorBackward(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "D");
+            outputCsi(a_uiN, 'D');
         }
 
         void TerminalAnsi::moveCursorToNextLine(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "E");
+            outputCsi(a_uiN, 'E');
         }
 
         void TerminalAnsi::moveCursorToPreviousLine(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "F");
+            outputCsi(a_uiN, 'F');
         }
 
         void TerminalAnsi::moveCursorToRow(unsigned int const a_uiR) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiR) + "G");
+            outputCsi(a_uiR, 'G');
         }
 
         void TerminalAnsi::moveCursorToColumn(unsigned int const a_uiC) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiC) + "d");
+            outputCsi(a_uiC, 'd');
         }
 
         void TerminalAnsi::moveCursorToPosition(unsigned int const a_uiR, unsigned int const a_uiC) const noexcept {
             if (!supportsColor()) {
                 if (1 == a_uiC) {
-                    write("\r");
+                    output("\r");
                 }
                 return;
             }
-            write(s_CSI + to_string(a_uiR) + ";" + to_string(a_uiC) + "H");
+            outputCsi(a_uiR, a_uiC, 'H');
         }
 
         void TerminalAnsi::saveCursor() const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_ESC + "7");
+            output("\0337");
         }
 
         void TerminalAnsi::restoreCursor() const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_ESC + "8");
+            output("\0338");
         }
 
         void TerminalAnsi::setCursorBlinking(bool const a_bBlinking) const noexcept {
@@ -220,10 +356,10 @@ namespace emb {
                 return;
             }
             if (a_bBlinking) {
-                write(s_CSI + "?12h");
+                output("\033[?12h");
             }
             else {
-                write(s_CSI + "?12l");
+                output("\033[?12l");
             }
         }
 
@@ -232,10 +368,10 @@ namespace emb {
                 return;
             }
             if (a_bVisible) {
-                write(s_CSI + "?25h");
+                output("\033[?25h");
             }
             else {
-                write(s_CSI + "?25l");
+                output("\033[?25l");
             }
         }
 
@@ -243,153 +379,92 @@ namespace emb {
             if (!supportsColor()) {
                 return;
             }
-            switch (a_eShape)
-            {
-            case SetCursorShape::Shape::UserDefault:        ///< Default cursor shape configured by the user
-                write(s_CSI + "0 q");
-                break;
-            case SetCursorShape::Shape::BlinkingBlock:      ///< Blinking block cursor shape
-                write(s_CSI + "1 q");
-                break;
-            case SetCursorShape::Shape::SteadyBlock:        ///< Steady block cursor shape
-                write(s_CSI + "2 q");
-                break;
-            case SetCursorShape::Shape::BlinkingUnderline:  ///< Blinking underline cursor shape
-                write(s_CSI + "3 q");
-                break;
-            case SetCursorShape::Shape::SteadyUnderline:    ///< Steady underline cursor shape
-                write(s_CSI + "4 q");
-                break;
-            case SetCursorShape::Shape::BlinkingBar:        ///< Blinking bar cursor shape
-                write(s_CSI + "5 q");
-                break;
-            case SetCursorShape::Shape::SteadyBar:          ///< Steady bar cursor shape
-                write(s_CSI + "6 q");
-                break;
-            }
+            Sequence const& shape = s_aCursorShapes[static_cast<size_t>(a_eShape)];
+            output(shape.pData, shape.ulSize);
         }
 
         void TerminalAnsi::scrollUp(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "S");
+            outputCsi(a_uiN, 'S');
         }
 
         void TerminalAnsi::scrollDown(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "T");
+            outputCsi(a_uiN, 'T');
         }
 
         void TerminalAnsi::insertCharacter(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "@");
+            outputCsi(a_uiN, '@');
         }
 
         void TerminalAnsi::deleteCharacter(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "P");
+            outputCsi(a_uiN, 'P');
         }
 
         void TerminalAnsi::eraseCharacter(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "X");
+            outputCsi(a_uiN, 'X');
         }
 
         void TerminalAnsi::insertLine(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "L");
+            outputCsi(a_uiN, 'L');
         }
 
         void TerminalAnsi::deleteLine(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "M");
+            outputCsi(a_uiN, 'M');
         }
 
         void TerminalAnsi::clearDisplay(ClearDisplay::Type const a_eType) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            switch (a_eType)
-            {
-            case ClearDisplay::Type::FromCursorToEnd:
-                write(s_CSI + "0J");
-                break;
-            case ClearDisplay::Type::FromBeginningToCursor:
-                write(s_CSI + "1J");
-                break;
-            case ClearDisplay::Type::All:
-                write(s_CSI + "2J");
-                break;
-            }
+            Sequence const& clear = s_aClearDisplays[static_cast<size_t>(a_eType)];
+            output(clear.pData, clear.ulSize);
         }
 
         void TerminalAnsi::clearLine(ClearLine::Type const a_eType) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            switch (a_eType)
-            {
-            case ClearLine::Type::FromCursorToEnd:
-                write(s_CSI + "0K");
-                break;
-            case ClearLine::Type::FromBeginningToCursor:
-                write(s_CSI + "1K");
-                break;
-            case ClearLine::Type::All:
-                write(s_CSI + "2K");
-                break;
-            }
+            Sequence const& clear = s_aClearLines[static_cast<size_t>(a_eType)];
+            output(clear.pData, clear.ulSize);
         }
 
         void TerminalAnsi::resetTextFormat() const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + "0m");
+            output("\033[0m");
         }
 
         void TerminalAnsi::setColor(SetColor::Color const a_eFgColor, SetColor::Color const a_eBgColor) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            static const unordered_map<SetColor::Color, pair<string, string>> s_Colors{
-                { SetColor::Color::Black,          make_pair("30", "40")   },
-                { SetColor::Color::Red,            make_pair("31", "41")   },
-                { SetColor::Color::Green,          make_pair("32", "42")   },
-                { SetColor::Color::Yellow,         make_pair("33", "43")   },
-                { SetColor::Color::Blue,           make_pair("34", "44")   },
-                { SetColor::Color::Magenta,        make_pair("35", "45")   },
-                { SetColor::Color::Cyan,           make_pair("36", "46")   },
-                { SetColor::Color::White,          make_pair("37", "47")   },
-                { SetColor::Color::BrightBlack,    make_pair("90", "100")  },
-                { SetColor::Color::BrightRed,      make_pair("91", "101")  },
-                { SetColor::Color::BrightGreen,    make_pair("92", "102")  },
-                { SetColor::Color::BrightYellow,   make_pair("93", "103")  },
-                { SetColor::Color::BrightBlue,     make_pair("94", "104")  },
-                { SetColor::Color::BrightMagenta,  make_pair("95", "105")  },
-                { SetColor::Color::BrightCyan,     make_pair("96", "106")  },
-                { SetColor::Color::BrightWhite,    make_pair("97", "107")  },
-                { SetColor::Color::Default,        make_pair("37", "")     },
-            };
-            if (!s_Colors.at(a_eBgColor).second.empty()) {
-                write(s_CSI + s_Colors.at(a_eFgColor).first + ";" + s_Colors.at(a_eBgColor).second + "m");
-            }
-            else {
-                write(s_CSI + s_Colors.at(a_eFgColor).first + "m");
-            }
+            Sequence const& foreground = s_aForegroundColors[static_cast<size_t>(a_eFgColor)];
+            Sequence const& background = s_aBackgroundColors[static_cast<size_t>(a_eBgColor)];
+            char acSequence[16]{};
+            memcpy(acSequence, foreground.pData, foreground.ulSize);
+            memcpy(acSequence + foreground.ulSize, background.pData, background.ulSize);
+            output(acSequence, foreground.ulSize + background.ulSize);
         }
 
         void TerminalAnsi::setNegativeColors(bool const a_bEnabled) const noexcept {
@@ -397,10 +472,10 @@ namespace emb {
                 return;
             }
             if (a_bEnabled) {
-                write(s_CSI + "7m");
+                output("\033[7m");
             }
             else {
-                write(s_CSI + "27m");
+                output("\033[27m");
             }
         }
 
@@ -409,10 +484,10 @@ namespace emb {
                 return;
             }
             if (a_bEnabled) {
-                write(s_CSI + "1m");
+                output("\033[1m");
             }
             else {
-                write(s_CSI + "22m");
+                output("\033[22m");
             }
         }
 
@@ -421,10 +496,10 @@ namespace emb {
                 return;
             }
             if (a_bEnabled) {
-                write(s_CSI + "3m");
+                output("\033[3m");
             }
             else {
-                write(s_CSI + "23m");
+                output("\033[23m");
             }
         }
 
@@ -433,10 +508,10 @@ namespace emb {
                 return;
             }
             if (a_bEnabled) {
-                write(s_CSI + "4m");
+                output("\033[4m");
             }
             else {
-                write(s_CSI + "24m");
+                output("\033[24m");
             }
         }
 
@@ -444,21 +519,21 @@ namespace emb {
             if (!supportsColor()) {
                 return;
             }
-            write(s_ESC + "H");
+            output("\033H");
         }
 
         void TerminalAnsi::goToHorizontalTabForward(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "I");
+            outputCsi(a_uiN, 'I');
         }
 
         void TerminalAnsi::goToHorizontalTabBackward(unsigned int const a_uiN) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiN) + "Z");
+            outputCsi(a_uiN, 'Z');
         }
 
         void TerminalAnsi::clearHorizontalTab(ClearHorizontalTab::Type const a_eType) const noexcept {
@@ -468,10 +543,10 @@ namespace emb {
             switch (a_eType)
             {
             case ClearHorizontalTab::Type::CurrentColumn:
-                write(s_CSI + "0g");
+                output("\033[0g");
                 break;
             case ClearHorizontalTab::Type::AllColumns:
-                write(s_CSI + "3g");
+                output("\033[3g");
                 break;
             }
         }
@@ -481,10 +556,10 @@ namespace emb {
                 return;
             }
             if (a_bEnabled) {
-                write(s_ESC + "(0");
+                output("\033(0");
             }
             else {
-                write(s_ESC + "(B");
+                output("\033(B");
             }
         }
 
@@ -493,27 +568,19 @@ namespace emb {
                 return;
             }
             if (PrintSymbol::Symbol::Space == a_eSymbol) {
-                write(" ");
+                output(" ");
             }
             else {
-                static const unordered_map<PrintSymbol::Symbol, string> s_SymbolsMap{
-                        { PrintSymbol::Symbol::BottomRight,    "j" },
-                        { PrintSymbol::Symbol::TopRight,       "k" },
-                        { PrintSymbol::Symbol::TopLeft,        "l" },
-                        { PrintSymbol::Symbol::BottomLeft,     "m" },
-                        { PrintSymbol::Symbol::Cross,          "n" },
-                        { PrintSymbol::Symbol::HorizontalBar,  "q" },
-                        { PrintSymbol::Symbol::LeftCross,      "t" },
-                        { PrintSymbol::Symbol::RightCross,     "u" },
-                        { PrintSymbol::Symbol::BottomCross,    "v" },
-                        { PrintSymbol::Symbol::TopCross,       "w" },
-                        { PrintSymbol::Symbol::VerticalBar,    "x" },
-                };
-                write(s_ESC + "(0");
-                for (unsigned int i = 0; i < a_uiN; ++i) {
-                    write(s_SymbolsMap.at(a_eSymbol));
+                // The symbols are output by chunks, a run of symbols costs a few copies
+                char acSymbols[64]{};
+                memset(acSymbols, s_acSymbols[static_cast<size_t>(a_eSymbol)], sizeof(acSymbols));
+                output("\033(0");
+                for (unsigned int uiLeft = a_uiN; uiLeft > 0;) {
+                    size_t const ulChunk{ min<size_t>(uiLeft, sizeof(acSymbols)) };
+                    output(acSymbols, ulChunk);
+                    uiLeft -= static_cast<unsigned int>(ulChunk);
                 }
-                write(s_ESC + "(B");
+                output("\033(B");
             }
         }
 
@@ -521,15 +588,17 @@ namespace emb {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + to_string(a_uiT) + ";" + to_string(a_uiB) + "r");
+            outputCsi(a_uiT, a_uiB, 'r');
         }
 
         void TerminalAnsi::setWindowTitle(std::string const& a_strTitle) const noexcept {
             if (!supportsColor()) {
                 return;
             }
-            write(s_OSC + "0;" + a_strTitle + s_ST);
-            // or ? write(s_OSC + "2;" + a_strTitle + s_ST);
+            output("\033]0;");
+            output(a_strTitle);
+            output("\033\\");
+            // or ? output("\033]2;") + title + ST
         }
 
         void TerminalAnsi::useAlternateScreenBuffer(bool const& a_bEnabled) const noexcept {
@@ -537,10 +606,10 @@ namespace emb {
                 return;
             }
             if (a_bEnabled) {
-                write(s_CSI + "?1049h");
+                output("\033[?1049h");
             }
             else {
-                write(s_CSI + "?1049l");
+                output("\033[?1049l");
             }
         }
 
@@ -548,19 +617,19 @@ namespace emb {
             if (!supportsColor()) {
                 return;
             }
-            write(s_CSI + "!p");
+            output("\033[!p");
         }
 
         void TerminalAnsi::ringBell() const noexcept {
-            write("\a");
+            output("\a");
         }
 
         void TerminalAnsi::printNewLine() const noexcept {
-            write("\r\n");
+            output("\r\n");
         }
 
         void TerminalAnsi::printText(std::string const& a_strText) const noexcept {
-            write(a_strText);
+            output(a_strText);
         }
 
         void TerminalAnsi::printTextAt(std::string const& a_strText, unsigned int const a_uiR, unsigned int const a_uiC) const noexcept {
@@ -637,6 +706,12 @@ namespace emb {
             else if ("\x1b" == a_strKey) {
                 Terminal::processPressedKey(Key::Escape);
             }
+            else if ("\x03" == a_strKey) {
+                Terminal::processPressedKey(Key::CtrlC);
+            }
+            else if ("\x12" == a_strKey) {
+                Terminal::processPressedKey(Key::CtrlR);
+            }
             else if ("\x1b\x4f\x50" == a_strKey ||
                 "\x1b\x5b\x31\x31\x7e" == a_strKey) {
                 Terminal::processPressedKey(Key::F1);
@@ -685,6 +760,12 @@ namespace emb {
                     else if ('\x0d' == c || '\x0a' == c) {
                         Terminal::processPressedKey(Key::Enter);
                     }
+                    else if ('\x03' == c) {
+                        Terminal::processPressedKey(Key::CtrlC);
+                    }
+                    else if ('\x12' == c) {
+                        Terminal::processPressedKey(Key::CtrlR);
+                    }
                     else {
                         //cerr << "Unknown key pressed : " << a_strKey << " 0x" << string_to_hex(a_strKey) << endl;
                         //system("pause");
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Terminal.hpp"
+#include "OutputWriter.hpp"
 
 namespace emb {
     namespace console {
@@ -15,15 +16,56 @@ namespace emb {
             TerminalAnsi& operator= (TerminalAnsi const&) noexcept = delete;
             TerminalAnsi& operator= (TerminalAnsi&&) noexcept = delete;
 
+        protected:
+            enum RenderClass : unsigned int {
+                Color = 1 << 0,         ///< Escape sequences are output
+                BareNewLine = 1 << 1    ///< New lines are output as "\n" instead of "\r\n"
+            };
+
         protected:
             void requestTerminalSize() const noexcept;
             bool parseTerminalSizeResponse(std::string& a_strResponse) noexcept;
 
             //virtual bool read(std::string& a_rstrKey) const noexcept = 0;
             virtual bool write(std::string const& a_strDataToPrint) const noexcept override;
+            /**
+             * @brief Writes data without copying it, if the terminal can
+             * @param a_pData   Data, which must stay valid until commit()
+             * @param a_ulSize  Size of the data
+             */
+            virtual void writeReference(char const* a_pData, size_t a_ulSize) const noexcept;
+            /**
+             * @brief Writes a copy of data, which may be released as soon as the call returns
+             * @param a_pData   Data
+             * @param a_ulSize  Size of the data
+             */
+            virtual void writeCopy(char const* a_pData, size_t a_ulSize) const noexcept;
 
             void processCapture() const noexcept;
 
+            /**
+             * @brief Gives the class of the terminal: terminals of the same class render the same print commands into the same
+             *        bytes, so a committed batch shared by several of them is rendered only once
+             * @return unsigned int The class, a combination of RenderClass flags
+             */
+            virtual unsigned int getRenderClass() const noexcept { return supportsColor() ? static_cast<unsigned int>(RenderClass::Color) : 0; }
+            void replayPrintCommands(SharedPrintBatch const& a_PrintBatch) noexcept override;
+            void output(std::string const& a_strData) const noexcept;
+            void output(char const* a_pData, size_t a_ulSize) const noexcept;
+            /// Outputs a literal, whose size is known at compile time
+            template<size_t N>
+            void output(char const (&a_szLiteral)[N]) const noexcept {
+                if (m_pstrRendering) {
+                    output(a_szLiteral, N - 1);
+                }
+                else {
+                    writeReference(a_szLiteral, N - 1);
+                }
+            }
+            /// Outputs a control sequence with one or two numeric parameters: CSI n [; m] final
+            void outputCsi(unsigned int const a_uiN, char const a_cFinal) const noexcept;
+            void outputCsi(unsigned int const a_uiN1, unsigned int const a_uiN2, char const a_cFinal) const noexcept;
+
             void begin() const noexcept override;
             void commit() const noexcept override;
             void moveCursorUp(unsigned int const a_uiN) const noexcept override;
@@ -77,7 +119,9 @@ namespace emb {
                 SizeRequest,
             };
             DSRState m_eDSRState{ DSRState::PositionRequest };
-            mutable std::string m_strDataToPrint{};
+            mutable OutputWriter m_Output{};
+            mutable std::string* m_pstrRendering{ nullptr };    ///< Set while a batch is rendered: receives the committed output
+            mutable std::string m_strRenderedTransaction{};
         };
     } // console
 } // emb
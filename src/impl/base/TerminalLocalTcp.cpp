@@ -1,6 +1,7 @@
 #include "TerminalLocalTcp.hpp"
 #include "../Tools.hpp"
 #include <chrono>
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #ifdef _WIN32
@@ -111,20 +112,26 @@ namespace emb {
             processPrintCommands();
             processUserCommands();
 
-            static chrono::time_point<chrono::steady_clock> timepoint{ chrono::steady_clock::now() };
-            if (!m_bSupportsColor) {
-                Size s;
-                s.iWidth = 999;
-                s.iHeight = 999;
-                setCurrentSize(s);
-                write(" \b");
-            }
-            else if (timepoint <= chrono::steady_clock::now()) {
-                requestTerminalSize();
-                timepoint = chrono::steady_clock::now() + chrono::milliseconds(1000);
+            // The terminal size is polled, and so is the connection when the client does not answer the size requests
+            if (m_NextSizeRequest <= chrono::steady_clock::now()) {
+                if (!m_bSupportsColor) {
+                    Size s;
+                    s.iWidth = 999;
+                    s.iHeight = 999;
+                    setCurrentSize(s);
+                    write(" \b");
+                }
+                else {
+                    requestTerminalSize();
+                }
+                m_NextSizeRequest = chrono::steady_clock::now() + chrono::milliseconds(1000);
             }
         }
 
+        chrono::steady_clock::time_point TerminalLocalTcp::getNextTimeout() const noexcept {
+            return min(TerminalAnsi::getNextTimeout(), m_NextSizeRequest);
+        }
+
         void TerminalLocalTcp::stop() noexcept {
             TerminalAnsi::stop();
             int status = shutdown_socket(m_iServerSocket);
@@ -160,12 +167,22 @@ namespace emb {
         }
 
         bool TerminalLocalTcp::write(std::string const& a_strDataToPrint) const noexcept {
+            writeReference(a_strDataToPrint.data(), a_strDataToPrint.size());
+            return true;
+        }
+
+        void TerminalLocalTcp::writeReference(char const* a_pData, size_t a_ulSize) const noexcept {
             lock_guard<mutex> const l{ m_Mutex };
             if (!m_bStopClient) {
-                m_strDataToSend += a_strDataToPrint;
+                // Copied: the data is sent by the transmission thread
+                m_strDataToSend.append(a_pData, a_ulSize);
             }
             m_ConditionVariableTx.notify_one();
-            return true;
+        }
+
+        void TerminalLocalTcp::writeCopy(char const* a_pData, size_t a_ulSize) const noexcept {
+            // The data is already copied for the transmission thread
+            writeReference(a_pData, a_ulSize);
         }
 
         void TerminalLocalTcp::serverLoop() noexcept {
@@ -198,8 +215,11 @@ namespace emb {
 
                 int data_recv = recv(a_iClientSocket, recv_buf, 100, 0);
                 if (data_recv > 0) {
-                    lock_guard<mutex> const l{ m_Mutex };
-                    m_strReceivedData += recv_buf;
+                    {
+                        lock_guard<mutex> const l{ m_Mutex };
+                        m_strReceivedData += recv_buf;
+                    }
+                    wakeUpEventLoop();
                 }
             }
         }
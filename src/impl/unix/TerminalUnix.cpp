@@ -41,6 +41,9 @@ namespace emb {
                     }
                     old.c_lflag &= ~ICANON;
                     old.c_lflag &= ~ECHO;
+                    // Ctrl-C is read as a key, to cancel the foreground command. The other signal keys (Ctrl-Z, Ctrl-\) keep working.
+                    m_cInterruptChar = old.c_cc[VINTR];
+                    old.c_cc[VINTR] = _POSIX_VDISABLE;
                     old.c_cc[VMIN] = 1;
                     old.c_cc[VTIME] = 0;
                     if(tcsetattr(STDIN_FILENO, TCSANOW, &old) < 0) {
@@ -85,6 +88,7 @@ namespace emb {
                     }
                     old.c_lflag |= ICANON;
                     old.c_lflag |= ECHO;
+                    old.c_cc[VINTR] = m_cInterruptChar;
                     old.c_cc[VMIN] = 1;
                     old.c_cc[VTIME] = 0;
                     if (tcsetattr(STDIN_FILENO, TCSANOW, &old) < 0) {
@@ -96,6 +100,11 @@ namespace emb {
             }
         }
 
+        void TerminalUnix::interruptApplication() noexcept {
+            // Nothing to cancel: Ctrl-C interrupts the application as if the terminal had generated the signal
+            std::raise(SIGINT);
+        }
+
         bool TerminalUnix::supportsInteractivity() const noexcept {
             return true;
         }
@@ -121,8 +130,16 @@ namespace emb {
             return false;
         }
 
+        int TerminalUnix::getInputFd() const noexcept {
+            return m_bStarted && m_bInputEnabled ? STDIN_FILENO : -1;
+        }
+
+        unsigned int TerminalUnix::getRenderClass() const noexcept {
+            return TerminalAnsi::getRenderClass() | RenderClass::BareNewLine;
+        }
+
         void TerminalUnix::printNewLine() const noexcept {
-            write("\n");
+            output("\n");
         }
     } // console
 } // emb
\ No newline at end of file
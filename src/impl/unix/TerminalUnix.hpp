@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../base/TerminalAnsi.hpp"
+#include <termios.h>
 
 namespace emb {
     namespace console {
@@ -24,12 +25,16 @@ namespace emb {
             bool supportsColor() const noexcept override;
 
             bool read(std::string& a_rstrKey) const noexcept override;
+            int getInputFd() const noexcept override;
 
+            unsigned int getRenderClass() const noexcept override;
             void printNewLine() const noexcept override;
+            void interruptApplication() noexcept override;
 
         private:
             bool m_bStarted{true}; // todo option
             bool m_bInputEnabled{false};
+            cc_t m_cInterruptChar{ 3 };     ///< Character of the terminal generating SIGINT, restored when stopped
         };
     } // console
 } // emb
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <sys/un.h>
 #include <sys/types.h>
 #include <chrono>
+#include <algorithm>
 
 /* CLIENT:
  * #!/bin/bash
@@ -133,20 +134,26 @@ namespace emb {
             processPrintCommands();
             processUserCommands();
 
-            static chrono::time_point<chrono::steady_clock> timepoint{chrono::steady_clock::now()};
-            if(!m_bSupportsColor) {
-                Size s;
-                s.iWidth = 999;
-                s.iHeight = 999;
-                setCurrentSize(s);
-                write(" \b");
-            }
-            else if(timepoint <= chrono::steady_clock::now()) {
-                requestTerminalSize();
-                timepoint = chrono::steady_clock::now() + chrono::milliseconds(1000);
+            // The terminal size is polled, and so is the connection when the client does not answer the size requests
+            if (m_NextSizeRequest <= chrono::steady_clock::now()) {
+                if (!m_bSupportsColor) {
+                    Size s;
+                    s.iWidth = 999;
+                    s.iHeight = 999;
+                    setCurrentSize(s);
+                    write(" \b");
+                }
+                else {
+                    requestTerminalSize();
+                }
+                m_NextSizeRequest = chrono::steady_clock::now() + chrono::milliseconds(1000);
             }
         }
 
+        chrono::steady_clock::time_point TerminalUnixSocket::getNextTimeout() const noexcept {
+            return min(TerminalAnsi::getNextTimeout(), m_NextSizeRequest);
+        }
+
         void TerminalUnixSocket::stop() noexcept {
             TerminalAnsi::stop();
             shutdown(m_iServerSocket, SHUT_RDWR);
@@ -178,12 +185,22 @@ namespace emb {
         }
 
         bool TerminalUnixSocket::write(std::string const& a_strDataToPrint) const noexcept {
+            writeReference(a_strDataToPrint.data(), a_strDataToPrint.size());
+            return true;
+        }
+
+        void TerminalUnixSocket::writeReference(char const* a_pData, size_t a_ulSize) const noexcept {
             lock_guard<mutex> const l{m_Mutex};
             if(!m_bStopClient) {
-                m_strDataToSend += a_strDataToPrint;
+                // Copied: the data is sent by the transmission thread
+                m_strDataToSend.append(a_pData, a_ulSize);
             }
             m_ConditionVariableTx.notify_one();
-            return true;
+        }
+
+        void TerminalUnixSocket::writeCopy(char const* a_pData, size_t a_ulSize) const noexcept {
+            // The data is already copied for the transmission thread
+            writeReference(a_pData, a_ulSize);
         }
 
         void TerminalUnixSocket::serverLoop() noexcept {
@@ -219,8 +236,11 @@ namespace emb {
 
                 int data_recv = recv(a_iClientSocket, recv_buf, 100, 0);
                 if(data_recv > 0) {
-                    lock_guard<mutex> const l{m_Mutex};
-                    m_strReceivedData += recv_buf;
+                    {
+                        lock_guard<mutex> const l{m_Mutex};
+                        m_strReceivedData += recv_buf;
+                    }
+                    wakeUpEventLoop();
                 }
             }
         }
@@ -23,6 +23,7 @@ namespace emb {
             void start() noexcept override;
             bool isKeyPressed(std::string& a_rstrPressedKey) noexcept;
             void processEvents() noexcept override;
+            std::chrono::steady_clock::time_point getNextTimeout() const noexcept override;
             void stop() noexcept override;
 
             bool supportsInteractivity() const noexcept override;
@@ -30,6 +31,8 @@ namespace emb {
 
             bool read(std::string& a_rstrKey) const noexcept override;
             bool write(std::string const& a_strDataToPrint) const noexcept override;
+            void writeReference(char const* a_pData, size_t a_ulSize) const noexcept override;
+            void writeCopy(char const* a_pData, size_t a_ulSize) const noexcept override;
 
         private:
             void serverLoop() noexcept;
@@ -52,6 +55,7 @@ namespace emb {
             mutable int m_iServerSocket{ 0 };
             mutable int m_iClientSocket{ 0 };
             mutable bool m_bSupportsColor{true};
+            std::chrono::steady_clock::time_point m_NextSizeRequest{};
         };
     } // console
 } // emb
\ No newline at end of file
@@ -187,6 +187,8 @@ namespace emb {
                         if (!strKeyCode.empty()) {
                             processPressedKeyCode(strKeyCode);
                         }
+                        // The size change and the entered commands are processed by the console thread
+                        wakeUpEventLoop();
                     }
                 }
             }
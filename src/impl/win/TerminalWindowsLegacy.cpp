@@ -372,6 +372,9 @@ namespace emb {
             else if ("\x1b" == a_strKey) {
                 Terminal::processPressedKey(Key::Escape);
             }
+            else if ("\x12" == a_strKey) {
+                Terminal::processPressedKey(Key::CtrlR);
+            }
             else if (std::string{ "\x00\x3b", 2 } == a_strKey) {
                 Terminal::processPressedKey(Key::F1);
             }
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <iostream>
+
+/**
+ * @brief Minimal checks of the debug programs: a failed check is reported with its location, and the program ends with
+ *        an error code
+ */
+namespace check {
+    inline int& failures() noexcept {
+        static int s_iFailures{ 0 };
+        return s_iFailures;
+    }
+
+    inline void report(bool const a_bOk, char const* a_szExpression, char const* a_szFile, int const a_iLine) noexcept {
+        if (!a_bOk) {
+            std::cerr << a_szFile << ":" << a_iLine << ": check failed: " << a_szExpression << std::endl;
+            ++failures();
+        }
+    }
+
+    /**
+     * @brief Gives the exit code of the program
+     */
+    inline int result(char const* a_szName) noexcept {
+        std::cout << a_szName << ": " << (0 == failures() ? "OK" : "FAILED") << std::endl;
+        return 0 == failures() ? 0 : 1;
+    }
+}
+
+#define CHECK(expression) check::report(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
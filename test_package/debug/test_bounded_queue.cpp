@@ -0,0 +1,105 @@
+#include "BoundedQueue.hpp"
+#include "check.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using emb::tools::BoundedQueue;
+
+/// Full and empty queue, the positions going around the slots many times
+static void testWrapAround() {
+    BoundedQueue<int> queue{ 4 };
+    CHECK(4 == queue.capacity());
+    int iValue{ 0 };
+    CHECK(!queue.tryPop(iValue));
+
+    int iNext{ 0 };
+    int iExpected{ 0 };
+    for (int iRound = 0; iRound < 1000; ++iRound) {
+        // Filled until full, from a different slot at each round
+        int const iPushed{ iRound % 3 + 2 };
+        for (int i = 0; i < iPushed; ++i) {
+            iValue = iNext++;
+            CHECK(queue.tryPush(iValue));
+        }
+        if (4 == iPushed) {
+            iValue = -1;
+            CHECK(!queue.tryPush(iValue));
+            CHECK(-1 == iValue);
+        }
+        // Emptied in order
+        for (int i = 0; i < iPushed; ++i) {
+            CHECK(queue.tryPop(iValue));
+            CHECK(iExpected++ == iValue);
+        }
+        CHECK(!queue.tryPop(iValue));
+    }
+}
+
+/// The values are exchanged with the slots: the producer gets back what the consumer left
+static void testExchange() {
+    BoundedQueue<std::string> queue{ 2 };
+    std::string strValue{ "first" };
+    CHECK(queue.tryPush(strValue));
+    CHECK(strValue.empty());
+    std::string strPopped{ "left" };
+    CHECK(queue.tryPop(strPopped));
+    CHECK("first" == strPopped);
+    // The slots are used in turn, the one released is reached after a full turn
+    strValue = "second";
+    CHECK(queue.tryPush(strValue));
+    CHECK(strValue.empty());
+    CHECK(queue.tryPop(strPopped));
+    strValue = "third";
+    CHECK(queue.tryPush(strValue));
+    CHECK("left" == strValue);
+}
+
+/// Several producers and consumers: every value is popped once
+static void testConcurrency() {
+    size_t const ulProducers{ 4 };
+    size_t const ulConsumers{ 4 };
+    long long const llByProducer{ 100000 };
+    BoundedQueue<long long> queue{ 64 };
+    std::atomic<long long> llSum{ 0 };
+    std::atomic<long long> llPopped{ 0 };
+    std::vector<std::thread> vThreads{};
+    for (size_t ulProducer = 0; ulProducer < ulProducers; ++ulProducer) {
+        vThreads.emplace_back([&queue, llByProducer] {
+            for (long long llValue = 1; llValue <= llByProducer; ++llValue) {
+                long long llPushed{ llValue };
+                while (!queue.tryPush(llPushed)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    long long const llTotal{ static_cast<long long>(ulProducers) * llByProducer };
+    for (size_t ulConsumer = 0; ulConsumer < ulConsumers; ++ulConsumer) {
+        vThreads.emplace_back([&queue, &llSum, &llPopped, llTotal] {
+            long long llValue{ 0 };
+            while (llPopped < llTotal) {
+                if (queue.tryPop(llValue)) {
+                    llSum += llValue;
+                    ++llPopped;
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : vThreads) {
+        thread.join();
+    }
+    CHECK(llTotal == llPopped);
+    CHECK(static_cast<long long>(ulProducers) * llByProducer * (llByProducer + 1) / 2 == llSum);
+}
+
+int main() {
+    testWrapAround();
+    testExchange();
+    testConcurrency();
+    return check::result("test_bounded_queue");
+}
@@ -0,0 +1,93 @@
+#include "CommandHistory.hpp"
+#include "check.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#ifdef unix
+#include <sys/stat.h>
+#endif
+
+namespace cs = emb::console;
+
+static char const* const s_szFilePath{ "test_command_history.txt" };
+
+static std::vector<std::string> readLines(char const* a_szFilePath) {
+    std::vector<std::string> vstrLines{};
+    std::ifstream file{ a_szFilePath };
+    std::string strLine{};
+    while (std::getline(file, strLine)) {
+        vstrLines.push_back(strLine);
+    }
+    return vstrLines;
+}
+
+/// The oldest entries are overwritten once the history is full
+static void testRing() {
+    cs::CommandHistory history{ cs::OptionHistory{ 3 } };
+    CHECK(0 == history.size());
+    CHECK(history.get(0).empty());
+    for (char const* szEntry : { "one", "two", "three", "four", "five" }) {
+        history.add(szEntry);
+    }
+    history.add("");
+    CHECK(3 == history.size());
+    CHECK(5 == history.count());
+    CHECK("five" == history.get(0));
+    CHECK("three" == history.get(2));
+    CHECK(history.get(3).empty());
+
+    CHECK(1 == history.search("fo", 0));
+    CHECK(std::string::npos == history.search("fo", 2));
+    CHECK(std::string::npos == history.search("two", 0));
+    CHECK(0 == history.search("", 0));
+}
+
+/// The entries are written to the file and read back in the same order
+static void testFileRoundTrip() {
+    std::remove(s_szFilePath);
+    {
+        cs::CommandHistory history{ cs::OptionHistory{ 10, s_szFilePath } };
+        history.add("first");
+        history.add("second\nline");
+        history.add("third");
+    }
+    CHECK((std::vector<std::string>{ "first", "third" } == readLines(s_szFilePath)));
+#ifdef unix
+    struct stat status{};
+    CHECK(0 == stat(s_szFilePath, &status) && 0600 == (status.st_mode & 0777));
+#endif
+    {
+        cs::CommandHistory history{ cs::OptionHistory{ 10, s_szFilePath } };
+        CHECK(2 == history.size());
+        CHECK("third" == history.get(0));
+        CHECK("first" == history.get(1));
+        history.add("fourth");
+    }
+    CHECK((std::vector<std::string>{ "first", "third", "fourth" } == readLines(s_szFilePath)));
+    std::remove(s_szFilePath);
+}
+
+/// A file much bigger than the history is rewritten with the entries kept
+static void testFileCompaction() {
+    {
+        std::ofstream file{ s_szFilePath, std::ios::out | std::ios::trunc };
+        for (int i = 0; i < 10; ++i) {
+            file << "entry" << i << '\n';
+        }
+    }
+    {
+        cs::CommandHistory history{ cs::OptionHistory{ 2, s_szFilePath } };
+        CHECK("entry9" == history.get(0));
+        CHECK("entry8" == history.get(1));
+    }
+    CHECK((std::vector<std::string>{ "entry8", "entry9" } == readLines(s_szFilePath)));
+    std::remove(s_szFilePath);
+}
+
+int main() {
+    testRing();
+    testFileRoundTrip();
+    testFileCompaction();
+    return check::result("test_command_history");
+}
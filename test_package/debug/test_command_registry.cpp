@@ -0,0 +1,59 @@
+#include "CommandRegistry.hpp"
+#include "check.hpp"
+
+namespace cs = emb::console;
+
+static cs::UserCommand command(char const* a_szPath) {
+    return cs::UserCommand{ cs::UserCommandInfo{ a_szPath }, cs::UserCommandFunctor0{ [] {} } };
+}
+
+/// A snapshot is never modified by the changes published after it
+static void testSnapshotIsolation() {
+    cs::CommandRegistry registry{};
+    registry.add({ command("/a/b"), command("/a/c"), command("/z/y") });
+    cs::CommandRegistry::SnapshotPtr const pBefore{ registry.get() };
+
+    registry.add({ command("/a/d") });
+    CHECK(registry.del("/a/b"));
+    CHECK(!registry.del("/a/b"));
+    CHECK(!registry.del("/unknown"));
+    cs::CommandRegistry::SnapshotPtr const pAfter{ registry.get() };
+
+    CHECK(nullptr != pBefore->find("/a/b"));
+    CHECK(nullptr == pBefore->find("/a/d"));
+    CHECK(3 == pBefore->commands().size());
+    CHECK(nullptr == pAfter->find("/a/b"));
+    CHECK(nullptr != pAfter->find("/a/d"));
+    CHECK(3 == pAfter->commands().size());
+
+    // Only the folders on the path of a change are copied, the others are shared
+    CHECK(pBefore->findNode("/z") == pAfter->findNode("/z"));
+    CHECK(pBefore->findNode("/a") != pAfter->findNode("/a"));
+    CHECK(pBefore->find("/a/c") == pAfter->find("/a/c"));
+
+    // A folder without any command left is removed
+    CHECK(registry.del("/z/y"));
+    CHECK(nullptr == registry.get()->findNode("/z"));
+    CHECK(nullptr != pAfter->findNode("/z"));
+
+    registry.clear();
+    CHECK(registry.get()->commands().empty());
+    CHECK(3 == pAfter->commands().size());
+}
+
+/// A command added again replaces the previous one, under the same path
+static void testReplace() {
+    cs::CommandRegistry registry{};
+    registry.add({ command("/a") });
+    cs::CommandRegistry::CommandPtr const pFirst{ registry.get()->find("/a") };
+    registry.add({ command("/a") });
+    cs::CommandRegistry::CommandPtr const pSecond{ registry.get()->find("/a") };
+    CHECK(nullptr != pFirst && nullptr != pSecond && pFirst != pSecond);
+    CHECK(1 == registry.get()->commands().size());
+}
+
+int main() {
+    testSnapshotIsolation();
+    testReplace();
+    return check::result("test_command_registry");
+}
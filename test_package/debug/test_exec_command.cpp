@@ -0,0 +1,57 @@
+#include "EmbConsole.hpp"
+#include "check.hpp"
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace cs = emb::console;
+using Status = cs::UserCommandResult::Status;
+
+static bool contains(std::string const& a_strText, char const* a_szPart) {
+    return std::string::npos != a_strText.find(a_szPart);
+}
+
+int main() {
+    {
+        auto pConsole = cs::Console::create(cs::Options{} + cs::OptionStd(false));
+        pConsole->addCommand("/hello", [](cs::UserCommandData const& a_Data) { a_Data.console.print("hello " + a_Data.args.at(0)); });
+        pConsole->addCommand("/throws", [](cs::UserCommandData const&) { throw std::runtime_error("boom"); });
+        pConsole->addCommand("/throws/unknown", [] { throw 42; });
+        pConsole->addCommand("/fails", [](cs::UserCommandData const& a_Data) { a_Data.fail(); });
+        pConsole->addCommand(cs::UserCommandInfo{ "/slow", "", "", {}, std::chrono::milliseconds{ 50 } }, [](cs::UserCommandData const& a_Data) {
+            a_Data.cancellation.waitFor(std::chrono::seconds{ 10 });
+        });
+
+        cs::UserCommandResult result{ pConsole->execCommand("/hello", { "world" }).get() };
+        CHECK(Status::Success == result.status);
+        CHECK(contains(result.output, "hello world"));
+
+        // An exception thrown by a command is reported as a failure, the console keeps running
+        result = pConsole->execCommand("/throws").get();
+        CHECK(Status::Failed == result.status);
+        CHECK(contains(result.output, "Command '/throws' failed: boom"));
+        result = pConsole->execCommand("/throws/unknown").get();
+        CHECK(Status::Failed == result.status);
+        CHECK(contains(result.output, "unknown exception"));
+        result = pConsole->execCommand("/hello", { "again" }).get();
+        CHECK(Status::Success == result.status);
+        CHECK(contains(result.output, "hello again"));
+
+        CHECK(Status::Failed == pConsole->execCommand("/fails").get().status);
+        CHECK(Status::Cancelled == pConsole->execCommand("/slow").get().status);
+        CHECK(Status::NotFound == pConsole->execCommand("/missing").get().status);
+
+        // A command still running when the console is destroyed is cancelled
+        pConsole->addCommand("/forever", [](cs::UserCommandData const& a_Data) {
+            while (!a_Data.cancellation.isCancelled()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+            }
+        });
+        auto future = pConsole->execCommand("/forever");
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+        pConsole.reset();
+        CHECK(Status::Cancelled == future.get().status);
+    }
+    return check::result("test_exec_command");
+}
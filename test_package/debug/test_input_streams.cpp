@@ -0,0 +1,65 @@
+#include "EmbConsole.hpp"
+#include "check.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#ifdef unix
+#include <unistd.h>
+#endif
+
+namespace cs = emb::console;
+
+#ifdef unix
+static size_t countLines(std::string const& a_strPath, char const* a_szPrefix) {
+    std::ifstream file{ a_strPath };
+    size_t ulLines{ 0 };
+    for (std::string strLine; std::getline(file, strLine);) {
+        ulLines += 0 == strLine.find(a_szPrefix) ? 1 : 0;
+    }
+    return ulLines;
+}
+
+/// The lines of a stream reach a blocking sink even when its queue is much shorter than a read of the stream
+static void testBlockingSink() {
+    std::string const strPath{ "test_input_streams.txt" };
+    std::remove(strPath.c_str());
+    cs::OutputQueuePolicy queue{};
+    queue.eOverflow = cs::OutputQueuePolicy::Overflow::Block;
+    queue.ulMaxRecords = 1;
+    queue.ulMaxBytes = 1024;
+    cs::OptionFile file{ true, strPath };
+    file.setOutputQueue(queue);
+    auto pConsole = cs::Console::create(cs::Options{} + cs::OptionStd(false) + file);
+
+    int aiPipe[2]{ -1, -1 };
+    CHECK(0 == pipe(aiPipe));
+    CHECK(pConsole->addInputStream("child", aiPipe[0]));
+    size_t const ulNbLines{ 20000 };
+    for (size_t i = 0; i < ulNbLines; ++i) {
+        std::string const strLine{ "line " + std::to_string(i) + "\n" };
+        CHECK(static_cast<ssize_t>(strLine.size()) == write(aiPipe[1], strLine.data(), strLine.size()));
+    }
+    close(aiPipe[1]);
+
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 10 };
+    while (countLines(strPath, "[child] line ") < ulNbLines && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+    }
+    CHECK(ulNbLines == countLines(strPath, "[child] line "));
+    for (cs::OutputQueueStats const& stats : pConsole->getOutputQueueStats()) {
+        CHECK(0 == stats.ulDropped);
+    }
+    pConsole.reset();
+    close(aiPipe[0]);
+    std::remove(strPath.c_str());
+}
+#endif
+
+int main() {
+#ifdef unix
+    testBlockingSink();
+#endif
+    return check::result("test_input_streams");
+}
@@ -0,0 +1,92 @@
+#include "EmbConsole.hpp"
+#include "check.hpp"
+#include <cstdint>
+#include <string>
+
+namespace cs = emb::console;
+namespace args = emb::console::arguments;
+
+template<typename T>
+static bool parse(std::string const& a_strArg, T& a_rValue) {
+    return args::Parser<T>::parse(a_strArg, a_rValue);
+}
+
+static void testIntegers() {
+    int iValue{ 0 };
+    CHECK(parse("42", iValue) && 42 == iValue);
+    CHECK(parse("-7", iValue) && -7 == iValue);
+    CHECK(!parse("", iValue));
+    CHECK(!parse(" 1", iValue));
+    CHECK(!parse("12a", iValue));
+    CHECK(!parse("1.5", iValue));
+    CHECK(-7 == iValue);
+
+    int8_t cValue{ 0 };
+    CHECK(parse("-128", cValue) && -128 == cValue);
+    CHECK(!parse("128", cValue));
+    CHECK(!parse("99999999999999999999", cValue));
+
+    unsigned int uiValue{ 0 };
+    CHECK(parse("4294967295", uiValue) && 4294967295u == uiValue);
+    CHECK(!parse("4294967296", uiValue));
+    CHECK(!parse("-1", uiValue));
+
+    uint64_t ulValue{ 0 };
+    CHECK(parse("18446744073709551615", ulValue) && UINT64_MAX == ulValue);
+    CHECK(!parse("18446744073709551616", ulValue));
+}
+
+static void testFloatingPoints() {
+    double dValue{ 0 };
+    CHECK(parse("1.5", dValue) && 1.5 == dValue);
+    CHECK(parse("-2e3", dValue) && -2000 == dValue);
+    CHECK(!parse("1.5x", dValue));
+    CHECK(!parse("", dValue));
+
+    float fValue{ 0 };
+    CHECK(parse("0.25", fValue) && 0.25f == fValue);
+    CHECK(!parse("1e39", fValue));
+}
+
+static void testOthers() {
+    bool bValue{ false };
+    CHECK(parse("yes", bValue) && bValue);
+    CHECK(parse("off", bValue) && !bValue);
+    CHECK(parse("1", bValue) && bValue);
+    CHECK(!parse("maybe", bValue));
+
+    std::string strValue{};
+    CHECK(parse("any text", strValue) && "any text" == strValue);
+
+    CHECK("Usage: /cmd <int> <string> <bool>" == (args::TypedCommand<int, std::string const&, bool>::usage("/cmd")));
+}
+
+/// The arguments of a typed command are checked before its function is called, a failure being reported
+static void testTypedCommand() {
+    auto const pConsole = cs::Console::create(cs::Options{} + cs::OptionStd(false));
+    int iCalls{ 0 };
+    pConsole->addCommand<int, double>("/typed", [&iCalls](int a_iValue, double a_dValue) {
+        CHECK(3 == a_iValue && 0.5 == a_dValue);
+        ++iCalls;
+    });
+
+    cs::UserCommandResult result{ pConsole->execCommand("/typed", { "3", "0.5" }).get() };
+    CHECK(cs::UserCommandResult::Status::Success == result.status);
+
+    result = pConsole->execCommand("/typed", { "3", "x" }).get();
+    CHECK(cs::UserCommandResult::Status::Failed == result.status);
+    CHECK(std::string::npos != result.output.find("Argument 2: 'x' is not a valid number"));
+
+    result = pConsole->execCommand("/typed", { "3" }).get();
+    CHECK(cs::UserCommandResult::Status::Failed == result.status);
+    CHECK(std::string::npos != result.output.find("Expected 2 argument(s), got 1"));
+    CHECK(1 == iCalls);
+}
+
+int main() {
+    testIntegers();
+    testFloatingPoints();
+    testOthers();
+    testTypedCommand();
+    return check::result("test_parser");
+}
@@ -0,0 +1,79 @@
+#include "EmbConsole.hpp"
+#include "PrintBatch.hpp"
+#include "check.hpp"
+#include <string>
+
+namespace cs = emb::console;
+
+/// Text a batch prints, without colors nor cursor moves
+static std::string textOf(cs::PrintBatch const& a_Batch, cs::FormattedTexts* a_pTexts = nullptr) {
+    std::string strText{};
+    a_Batch.appendText(strText, a_pTexts);
+    return strText;
+}
+
+/// Each "{}" is replaced by the next argument
+static void testFormatText() {
+    cs::FormatArg const aArgs[]{ cs::FormatArg(-12), cs::FormatArg(3u), cs::FormatArg(true), cs::FormatArg('c'), cs::FormatArg("text") };
+    std::string strText{};
+    char const szFormat[]{ "{} {} {} {} {} {{}} {}" };
+    cs::formatText(strText, szFormat, sizeof(szFormat) - 1, aArgs, 5);
+    CHECK("-12 3 true c text {} {}" == strText);
+}
+
+/// A format is built once, then reused by all the sinks of the batch
+static void testFormattedOnce() {
+    cs::FormatArg const aArgs[]{ cs::FormatArg(1), cs::FormatArg("two") };
+    cs::PrintBatch batch{};
+    batch.printFormat("a {}\nb {}", aArgs, 2);
+    batch.printFormat("c", nullptr, 0);
+
+    cs::FormattedTexts texts{};
+    CHECK(nullptr == texts.find(0));
+    CHECK("a 1\nb two\nc\n" == textOf(batch, &texts));
+    CHECK(nullptr != texts.find(0) && "a 1\nb two" == *texts.find(0));
+    CHECK(nullptr != texts.find(1) && "c" == *texts.find(1));
+    CHECK(nullptr == texts.find(2));
+    CHECK("a 1\nb two\nc\n" == textOf(batch, &texts));
+    CHECK(nullptr == texts.find(2));
+    texts.clear();
+    CHECK(nullptr == texts.find(0));
+}
+
+/// A copy owns its format and its arguments, and prints as the command it was copied from
+static void testCopy() {
+    std::string strFormat{ "{} and {}\nend" };
+    std::string strArg{ "first" };
+    cs::FormatArg const aArgs[]{ cs::FormatArg(strArg), cs::FormatArg(2.5) };
+    cs::PrintCommand::Ptr pCopy{};
+    cs::PrintBatch original{};
+    {
+        cs::PrintFormat const format{ strFormat.c_str(), aArgs, 2 };
+        format.encode(original);
+        pCopy = format.copy();
+    }
+    strFormat.assign(strFormat.size(), '?');
+    strArg.assign(strArg.size(), '?');
+    CHECK(nullptr != std::dynamic_pointer_cast<cs::PrintFormat>(pCopy));
+    cs::PrintBatch copied{};
+    pCopy->encode(copied);
+    CHECK("first and 2.5\nend\n" == textOf(copied));
+    CHECK(textOf(original) == textOf(copied));
+}
+
+/// The capture of a command receives the formatted text
+static void testCapture() {
+    auto pConsole = cs::Console::create(cs::Options{} + cs::OptionStd(false));
+    pConsole->addCommand("/format", [](cs::UserCommandData const& a_Data) { a_Data.console.print("{} + {} = {}", 1, 2, 3); });
+    cs::UserCommandResult const result{ pConsole->execCommand("/format").get() };
+    CHECK(cs::UserCommandResult::Status::Success == result.status);
+    CHECK(std::string::npos != result.output.find("1 + 2 = 3\n"));
+}
+
+int main() {
+    testFormatText();
+    testFormattedOnce();
+    testCopy();
+    testCapture();
+    return check::result("test_print_format");
+}
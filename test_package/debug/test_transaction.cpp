@@ -0,0 +1,66 @@
+#include "EmbConsole.hpp"
+#include "ConsolePrivate.hpp"
+#include "check.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace cs = emb::console;
+
+static bool contains(std::string const& a_strText, char const* a_szPart) {
+    return std::string::npos != a_strText.find(a_szPart);
+}
+
+/// A transaction interrupted by an exception is abandoned: it neither publishes its commands nor captures the next ones
+static void testException() {
+    cs::ConsoleSessionCapture capture{};
+    try {
+        cs::Transaction transaction{ capture };
+        capture << cs::PrintText("stale") << cs::PrintNewLine();
+        throw std::runtime_error("interrupted");
+    }
+    catch (std::exception const&) {
+    }
+    capture.print("fresh");
+    capture << cs::PrintText("outside");
+    CHECK(contains(capture.output(), "fresh"));
+    CHECK(!contains(capture.output(), "stale"));
+    CHECK(!contains(capture.output(), "outside"));
+}
+
+/// Rollback abandons nested Begin at once, and the transactions of the other sessions are kept
+static void testRollback() {
+    cs::ConsoleSessionCapture capture{};
+    cs::ConsoleSessionCapture other{};
+    other << cs::Begin() << cs::PrintText("kept");
+    capture << cs::Begin() << cs::PrintText("first") << cs::Begin() << cs::PrintText("second") << cs::Rollback();
+    capture << cs::Commit() << cs::Commit();
+    CHECK(capture.output().empty());
+    capture << cs::Rollback();
+    other << cs::Commit();
+    CHECK("kept" == other.output());
+
+    cs::Transaction transaction{ capture };
+    capture << cs::PrintText("committed");
+    transaction.commit();
+    CHECK("committed" == capture.output());
+}
+
+/// A command throwing in the middle of a transaction only reports its failure
+static void testCommand() {
+    auto pConsole = cs::Console::create(cs::Options{} + cs::OptionStd(false));
+    pConsole->addCommand("/throws", [](cs::UserCommandData const& a_Data) {
+        a_Data.console << cs::Begin() << cs::PrintText("stale");
+        throw std::runtime_error("boom");
+    });
+    cs::UserCommandResult const result{ pConsole->execCommand("/throws").get() };
+    CHECK(cs::UserCommandResult::Status::Failed == result.status);
+    CHECK(contains(result.output, "Command '/throws' failed: boom"));
+    CHECK(!contains(result.output, "stale"));
+}
+
+int main() {
+    testException();
+    testRollback();
+    testCommand();
+    return check::result("test_transaction");
+}